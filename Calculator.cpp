@@ -3,6 +3,7 @@
 #include "Expander.h"
 
 #include <chrono>
+#include <algorithm>
 
 // this text is just for testing
 using namespace std::chrono;
@@ -95,6 +96,21 @@ namespace orchestracpp
 	{
 		try
 		{
+			if (optimized)
+			{
+				// the optimized system is shared, only the uneqs and the evaluation state are copied
+				state->makeCurrent();
+				variables->evaluateConstants();
+				Calculator* tmp = new Calculator(*this);
+				tmp->system = (system != nullptr) ? system : this;
+				tmp->uneqs = uneqs->clone();
+				tmp->state = new VarGroupState(*state);
+				tmp->localLastSuccessfulNode = nullptr;
+				tmp->lastSuccessfulNode2 = nullptr;
+				tmp->orgNode = nullptr;
+				tmp->lastSuccessfulStateValid = false;
+				return tmp;
+			}
 			return new Calculator(this);
 		}
 		catch (const ReadException &re)
@@ -151,6 +167,16 @@ namespace orchestracpp
 						(variables->addVariable(pl.get(0), pl.getDouble(1)))->immutable = true;
 					}
 				}
+				else if (word == "@parameter:") {
+					ParameterList pl(infile);
+					Var* var = (pl.size() == 2) ? variables->addVariable(pl.get(0), pl.getDouble(1)) : variables->get(pl.get(0));
+					if (var == nullptr) {
+						throw ReadException("@parameter: could not find variable " + pl.get(0));
+					}
+					var->immutable = true;
+					var->parameter = true;
+					var->setConstant(false);
+				}
 				else if (word == "@globalvar:") {
 					variables->addToGlobalVariables(variables->readOne(infile));
 				}
@@ -160,6 +186,25 @@ namespace orchestracpp
 				else if ((word == "@stage:") || (word == "@calc:")) {
 					expressions->readExpression(infile);
 				}
+				else if ((word == "@vector:") || (word == "@table:")) {
+					ParameterList pl(infile);
+					if (pl.size() < 2) {
+						throw ReadException(word + " expected a name and at least one element");
+					}
+					std::vector<std::string> elements;
+					for (int i = 1; i < pl.size(); i++) {
+						elements.push_back(pl.get(i));
+					}
+					if (word == "@vector:") {
+						expressions->parser->addVector(pl.get(0), elements);
+					}
+					else {
+						expressions->parser->addTable(pl.get(0), elements);
+					}
+				}
+				else if (word == "@vcalc:") {
+					expressions->readVectorExpression(infile);
+				}
 				else if ((word == "@uneq:") || (word == "uneq:")) {
 					IO::showMessage("@Uneq: type has become obsolete, please replace with Uneq2:");
 				}
@@ -193,6 +238,37 @@ namespace orchestracpp
 				else if (word == "@maxmineraliter:") {
 					uneqs->maxMineralIterations = infile->readInt();
 				}
+				else if (word == "@subspacenewton:") {
+					uneqs->subspaceNewton = true;
+				}
+				else if (word == "@adaptivedelta:") {
+					uneqs->adaptiveDelta = true;
+				}
+				else if (word == "@nocompile:") {
+					uneqs->compiled = false;
+				}
+				else if (word == "@nativecode:") {
+					uneqs->nativeCode = true;
+				}
+				else if (word == "@fastmath:") {
+					uneqs->fastMath = true;
+					expressions->parser->fastMath = true;
+				}
+				else if (word == "@nomassaction:") {
+					uneqs->massActionKernels = false;
+				}
+				else if (word == "@analyticjacobian:") {
+					uneqs->analyticJacobian = true;
+				}
+				else if (word == "@noplans:") {
+					uneqs->evaluationPlans = false;
+				}
+				else if (word == "@keepallexpressions:") {
+					expressions->eliminateDeadExpressions = false;
+				}
+				else if (word == "@rewrite:") {
+					expressions->parser->algebraicRewrites = true;
+				}
 				else if (word == "@stop:") {
 					stopIfFailed = true;
 					exitIfFailed = true;
@@ -201,6 +277,12 @@ namespace orchestracpp
 					std::cout << this->name << ": Exit if failedtrue" << std::endl;
 					exitIfFailed = true;
 				}
+				else if (word == "@batch:") {
+					batchWidth = infile->readInt();
+					if ((batchWidth != 0) && (batchWidth != 4) && (batchWidth != 8)) {
+						throw ReadException("@batch: the number of nodes should be 4 or 8");
+					}
+				}
 				else if (word == "@switchoniia:") {
 					switchOnIIA = true;
 				}
@@ -237,6 +319,22 @@ namespace orchestracpp
 		{
 			uneqs->read_one3(s);
 		}
+
+		for (auto u : uneqs->uneqs)
+		{
+			u->adaptiveDelta = uneqs->adaptiveDelta;
+			u->fastMath = uneqs->fastMath;
+		}
+
+		// nodes record whether they were solved with the initially inactive uneqs switched on
+		for (auto u : uneqs->uneqs)
+		{
+			if (u->initiallyInactive)
+			{
+				variables->addToGlobalVariables(variables->addVariable("iia_on", 0));
+				break;
+			}
+		}
 	}
 
 	bool Calculator::calculate2(Node* const node, StopFlag* flag) //throw(ReadException, ParserException, ExitException)
@@ -263,6 +361,12 @@ namespace orchestracpp
 	{
 		calculatorStopFlag = flag;
 
+		// the expression graph operates on the evaluation state of this calculator
+		if (state != nullptr)
+		{
+			state->makeCurrent();
+		}
+
 		// Here we store the original node
 		if (orgNode == nullptr)
 		{
@@ -280,6 +384,7 @@ namespace orchestracpp
 			iob1 = new NodeIOObject("", variables, node->nodeType);
 			failedIndex = node->nodeType->index("failed");
 			nodeIDIndex = node->nodeType->index("Node_ID");
+			iiaOnIndex  = node->nodeType->index("iia_on");
 		}
 
 		//**
@@ -299,64 +404,39 @@ namespace orchestracpp
 	// Here we start the actual calculation
 		if (uneqs->getIIApresent())
 		{
-
 			if (switchOnIIA)
 			{ // start with all uneqs switched on
 				uneqs->switchOnIIA();
 				calculationSuccessful = startTryCalc(localLastSuccessfulNode, node); //**************************************
 			}
-			else
-			{ // start with IIA uneqs switched off
-
-				IO::println("Try a first calculation with iia switched off....");
-				uneqs->switchOffIIA();
-				// store the original node
-				Node *originalNode = new Node(node->nodeType);
-				originalNode->clone(node);
-
-				// do a first calculation
+			else if ((iiaOnIndex >= 0) && (node->getvalue(iiaOnIndex) > 0.5))
+			{ // this node was solved with iia switched on before, so its unknowns are a good start estimation
+				uneqs->switchOnIIA();
 				calculationSuccessful = startTryCalc(localLastSuccessfulNode, node); //**************************************
 
-				if (calculationSuccessful)
-				{
-					IO::println("First calculation was successful!");
-					IO::print("Nr iterations: "); 
-					std::cout << uneqs->getTotalNrIter()<<std::endl;
-					IO::println("Repeat calculation with iia switched on..");
-					uneqs->switchOnIIA();
-					calculationSuccessful = startTryCalc(localLastSuccessfulNode, node); //**************************************
-					if (calculationSuccessful)
-					{
-						IO::println("This was successful!!");
-						IO::print("Nr iterations: ");
-						std::cout << uneqs->getTotalNrIter() << std::endl;
-					}
-
-					// repeat calculation with the original node
-					// with updated start estimations
-					copyUnknowns(node, originalNode);
-					calculationSuccessful = startTryCalc(localLastSuccessfulNode, originalNode); //**************************************
-
-			    	IO::print("Nr iterations: ");
-				 	std::cout << uneqs->getTotalNrIter() << std::endl;
-
-					node->clone(originalNode);
-
-				}
-				else
-				{
-					IO::println("First calculation was not successful");
+				if (!calculationSuccessful && !flag->isCancelled())
+				{ // the warm start did not work, so start again from the original node
+					node->clone(orgNode);
+					calculationSuccessful = bootstrapIIA(node);
 				}
-
-				delete originalNode;
-
-			} 
+			}
+			else
+			{ // start with IIA uneqs switched off
+				calculationSuccessful = bootstrapIIA(node);
+			}
 		}
 		else
 		{ // not first calculation
 			calculationSuccessful = startTryCalc(localLastSuccessfulNode, node); //**************************************
 		}
 
+		// record whether this node was solved with the iia uneqs switched on, so next time we can skip bootstrapIIA.
+		// A successful calculation always ends with these uneqs switched on, also when bootstrapIIA was used.
+		if (iiaOnIndex >= 0)
+		{
+			node->setValue(iiaOnIndex, calculationSuccessful ? 1 : 0);
+		}
+
 		if (calculationSuccessful && trying)
 		{
 			if(!silent) IO::println("Trying better start estimations was successful!!");
@@ -411,7 +491,7 @@ namespace orchestracpp
 			}
 			if (exitIfFailed)
 			{
-				flag->pleaseStop("Calculator exit if failed ");
+				flag->pleaseStopAll("Calculator exit if failed ");
 				throw (ExitException(name->name + ": Sorry, this calculation was not successful."));
 			}
 
@@ -436,6 +516,188 @@ namespace orchestracpp
 
 	}
 
+	int Calculator::calculateBatch(const std::vector<Node*>& nodes, StopFlag* flag)
+	{
+		int nrSuccessful = 0;
+		size_t first = 0;
+
+		// the first calculation optimizes and compiles the system
+		if (!optimized && !nodes.empty())
+		{
+			if (calculate(nodes[0], flag)) nrSuccessful++;
+			first = 1;
+		}
+
+		shareBatchInputs(nodes);
+
+		bool batches = (batchWidth > 0) && (uneqs->program != nullptr);
+		size_t step = batches ? batchWidth : nodes.size();
+
+		for (size_t n = first; n < nodes.size(); n += step)
+		{
+			int nrNodes = (int)std::min(step, nodes.size() - n);
+			if (batches && !flag->isCancelled())
+			{
+				solveBatch(&nodes[n], nrNodes, flag);
+			}
+			for (int m = 0; m < nrNodes; m++)
+			{
+				if (calculate(nodes[n + m], flag)) nrSuccessful++;
+			}
+		}
+		return nrSuccessful;
+	}
+
+	void Calculator::shareBatchInputs(const std::vector<Node*>& nodes)
+	{
+		ExpressionProgram* program = uneqs->program;
+		if ((program == nullptr) || nodes.empty())
+		{
+			return;
+		}
+
+		std::vector<bool> shared(program->getNrInputs(), false);
+		for (int i = 0; i < program->getNrInputs(); i++)
+		{
+			Var* var = program->getInputVar(i);
+			if (var->isUnknown)
+			{
+				continue;
+			}
+			int index = iob1->getNodeIndex(var);
+			bool same = true;
+			if (index >= 0)
+			{
+				double value = nodes[0]->getvalue(index);
+				for (size_t n = 1; same && (n < nodes.size()); n++)
+				{
+					same = (nodes[n]->getvalue(index) == value);
+				}
+			}
+			shared[i] = same;
+		}
+		program->setSharedInputs(shared);
+	}
+
+	void Calculator::solveBatch(Node* const* nodes, int nrNodes, StopFlag* flag)
+	{
+		if (state != nullptr)
+		{
+			state->makeCurrent();
+		}
+		if (uneqs->getBatchWidth() != batchWidth)
+		{
+			uneqs->initBatch(batchWidth);
+		}
+
+		// the batch is iterated with the initially inactive uneqs switched on, as calculate
+		// does for the nodes that were solved with these uneqs before
+		bool iiaPresent = uneqs->getIIApresent();
+		std::vector<bool> active;
+		for (auto uneq : uneqs->uneqs)
+		{
+			active.push_back(uneq->active);
+		}
+		uneqs->switchOnIIA();
+
+		std::vector<bool> minerals;
+		int nrLanes = 0;
+		for (int lane = 0; lane < batchWidth; lane++)
+		{
+			uneqs->batchLaneStates[lane] = UnEqGroup::BATCH_EMPTY;
+			if ((lane >= nrNodes) || (iiaPresent && !switchOnIIA && ((iiaOnIndex < 0) || (nodes[lane]->getvalue(iiaOnIndex) <= 0.5))))
+			{
+				continue;
+			}
+
+			iob1->copyToLocal(nodes[lane]);
+
+			// all lanes share the active uneqs, so they need the same minerals
+			std::vector<bool> laneMinerals;
+			for (auto uneq : uneqs->uneqs)
+			{
+				if (uneq->isType3)
+				{
+					laneMinerals.push_back(uneq->unknown->getIniValue() > 0);
+				}
+			}
+			if (nrLanes == 0)
+			{
+				minerals = laneMinerals;
+			}
+			else if (laneMinerals != minerals)
+			{
+				continue;
+			}
+
+			uneqs->loadBatchLane(lane);
+			nrLanes++;
+		}
+
+		if (nrLanes > 0)
+		{
+			int m = 0;
+			for (auto uneq : uneqs->uneqs)
+			{
+				if (uneq->isType3)
+				{
+					uneq->active = minerals[m++];
+				}
+			}
+
+			uneqs->iterateBatch(flag);
+
+			for (int lane = 0; lane < nrNodes; lane++)
+			{
+				if (uneqs->batchLaneStates[lane] != UnEqGroup::BATCH_CONVERGED)
+				{
+					continue;
+				}
+				for (size_t k = 0; k < uneqs->uneqs.size(); k++)
+				{
+					UnEq* uneq = uneqs->uneqs[k];
+					int index = nodes[lane]->nodeType->index(uneq->unknown->name);
+					if (uneq->active && (index >= 0))
+					{
+						nodes[lane]->setValue(index, uneqs->getBatchUnknown((int)k, lane));
+					}
+				}
+			}
+		}
+
+		for (size_t k = 0; k < uneqs->uneqs.size(); k++)
+		{
+			uneqs->uneqs[k]->active = active[k];
+		}
+	}
+
+	bool Calculator::bootstrapIIA(Node *node)// throw(ParserException)
+	{
+		uneqs->switchOffIIA();
+		// store the original node
+		Node *originalNode = new Node(node->nodeType);
+		originalNode->clone(node);
+
+		// do a first calculation
+		bool calculationSuccessful = startTryCalc(localLastSuccessfulNode, node); //**************************************
+
+		if (calculationSuccessful)
+		{
+			// repeat calculation with iia switched on
+			uneqs->switchOnIIA();
+			calculationSuccessful = startTryCalc(localLastSuccessfulNode, node); //**************************************
+
+			// repeat calculation with the original node
+			// with updated start estimations
+			copyUnknowns(node, originalNode);
+			calculationSuccessful = startTryCalc(localLastSuccessfulNode, originalNode); //**************************************
+			node->clone(originalNode);
+		}
+
+		delete originalNode;
+		return calculationSuccessful;
+	}
+
 	bool Calculator::startTryCalc(Node *last_successful_node, Node *node)// throw(ParserException)
 	{
 		trylevel = 0;
@@ -477,21 +739,25 @@ namespace orchestracpp
 		{
 			/* new node was successful copy content of new_node to last_successful node */
 			last_successful_node->clone(node);
+			variables->saveState(lastSuccessfulState);
+			lastSuccessfulStateValid = true;
 			trylevel--;
 			return true; // success
 		}
 
-		// We should first try to calculate the last successful node
-		if (!localCalculate(last_successful_node)) {
+		// We should first go back to the state of the last successful node, restoring
+		// the saved registers is much cheaper than calculating this node again
+		if (lastSuccessfulStateValid)
+		{
+			variables->restoreState(lastSuccessfulState);
+		}
+		else if (!localCalculate(last_successful_node)) {
 			IO::println(name->name + ": Last succesful node failed!");
 			return false;
 		}
 
-
-
 		// The calculation was not successful, so try to improve start estimations.
 		trying = true;
-		Node *originalNode = node->clone();
 
 
 		if (trylevel == 1)
@@ -543,10 +809,21 @@ namespace orchestracpp
 			auto t0 = high_resolution_clock::now();			
 			uneqs->initialise();
 			IO::println("Parsing expressions of " + name->name + "..... ");
-			int nrExpressions = expressions->initialize();
+			std::vector<Var*> requiredVariables = getRequiredVariables();
+			int nrExpressions = expressions->initialize(&requiredVariables);
 			IO::print("Optimizing expressions of " + name->name + "..... ");
 			
 			variables->optimizeExpressions(expressions->parser);
+			state = &variables->state;
+
+			if (uneqs->compiled)
+			{
+				uneqs->compileExpressions();
+				if (uneqs->nativeCode && (uneqs->program != nullptr))
+				{
+					uneqs->program->loadNativeCode(expandedText);
+				}
+			}
 
 			IO::print("Ready optimizing expressions of " + name->name + "..... ");
 
@@ -557,6 +834,42 @@ namespace orchestracpp
 			//variables->initializeParentsArrays(); Not necessary in C++
 		//	IO::println(std::to_string(variables->getNrVariables()) + " variables, " + std::to_string(nrExpressions) + " expressions, " + std::to_string(uneqs->nrActiveUneqs) + " equations.");
 			IO::println(std::to_string(variables->getNrVariables()) + " variables, " + std::to_string(nrExpressions) + " expressions, " + std::to_string(uneqs->uneqs.size()) + " equations.");
+			if (!silent && (expressions->nrSkippedExpressions > 0))
+			{
+				IO::println(std::to_string(expressions->nrSkippedExpressions) + " unused expressions skipped.");
+			}
+			if (!silent && (expressions->parser->nrMergedNodes > 0))
+			{
+				IO::println(std::to_string(expressions->parser->nrMergedNodes) + " identical subexpressions merged.");
+			}
+			if (!silent && (expressions->parser->nrRemovedNodes > 0))
+			{
+				IO::println(std::to_string(expressions->parser->allExpressionNodes.size()) + " expression nodes, " + std::to_string(expressions->parser->nrRemovedNodes) + " removed by optimization.");
+			}
+			if (!silent && expressions->parser->algebraicRewrites && (expressions->parser->nrRewrites > 0))
+			{
+				IO::println(std::to_string(expressions->parser->nrRewrites) + " algebraic rewrites.");
+			}
+			if (!silent && (uneqs->program != nullptr))
+			{
+				IO::println(std::to_string(uneqs->program->getNrInstructions()) + " compiled instructions.");
+				if (uneqs->program->getNrInvariantInstructions() > 0)
+				{
+					IO::println(std::to_string(uneqs->program->getNrInvariantInstructions()) + " input-invariant instructions evaluated once per node, " + std::to_string(uneqs->program->getNrVariantInstructions()) + " iteration-variant instructions evaluated in the Newton iteration.");
+				}
+				if (uneqs->program->getNrParameters() > 0)
+				{
+					IO::println(std::to_string(uneqs->program->getNrParameterInstructions()) + " instructions depend only on the " + std::to_string(uneqs->program->getNrParameters()) + " parameters, these are evaluated again when a parameter changes.");
+				}
+				if (uneqs->program->getNrMassActionBlocks() > 0)
+				{
+					IO::println(std::to_string(uneqs->program->getNrMassActionRows()) + " exponentials in " + std::to_string(uneqs->program->getNrMassActionBlocks()) + " mass action kernels.");
+				}
+				if (uneqs->program->getNrMassBalanceBlocks() > 0)
+				{
+					IO::println(std::to_string(uneqs->program->getNrMassBalanceRows()) + " mass balances in " + std::to_string(uneqs->program->getNrMassBalanceBlocks()) + " mass balance kernels.");
+				}
+			}
 			optimized = true;
 		}
 
@@ -579,6 +892,28 @@ namespace orchestracpp
 		return success;
 	}
 
+	std::vector<Var*> Calculator::getRequiredVariables()
+	{
+		std::vector<Var*> required;
+
+		for (auto uneq : uneqs->uneqs)
+		{
+			required.push_back(uneq->unknown);
+			required.push_back(uneq->equation);
+			if (uneq->siVariable != nullptr) required.push_back(uneq->siVariable);
+			if (uneq->toleranceVariable != nullptr) required.push_back(uneq->toleranceVariable);
+		}
+		if (uneqs->minTol != nullptr) required.push_back(uneqs->minTol);
+		if (uneqs->tolerance != nullptr) required.push_back(uneqs->tolerance);
+
+		required.insert(required.end(), variables->globalVariables.begin(), variables->globalVariables.end());
+		if (iob1 != nullptr)
+		{
+			iob1->getVariables(required);
+		}
+		return required;
+	}
+
 	void Calculator::copyUnknowns(Node *from, Node *to)
 	{
 		for (auto tmp : uneqs->uneqs)
@@ -615,4 +950,43 @@ namespace orchestracpp
 			variables->addToGlobalVariables(name);
 		}
 	}
+
+	void Calculator::setRetryMode(bool retry) {
+		if (retry == retryMode) {
+			return;
+		}
+		retryMode = retry;
+
+		if (retry) {
+			maxtry *= 2;
+			uneqs->maxIter *= 2;
+		}
+		else {
+			maxtry /= 2;
+			uneqs->maxIter /= 2;
+		}
+		uneqs->centralDifferences = retry;
+	}
+
+	void Calculator::setToleranceFactor(double factor) {
+		uneqs->setToleranceFactor(factor);
+	}
+
+	void Calculator::setParameter(const std::string& parameterName, double value) {
+		Var* var = variables->get(parameterName);
+		if ((var == nullptr) || !var->parameter) {
+			throw OrchestraException(parameterName + " is not a parameter of calculator " + name->name + ", it should be defined with @parameter:");
+		}
+
+		// the expression graph invalidates the memory nodes that depend on this parameter
+		if (state != nullptr) {
+			state->makeCurrent();
+		}
+		var->setValue(value);
+		lastSuccessfulStateValid = false; // the saved state still holds the old value
+
+		if (uneqs->program != nullptr) {
+			uneqs->program->setParameter(var, value);
+		}
+	}
 }
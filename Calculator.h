@@ -48,6 +48,11 @@ namespace orchestracpp
 
 		bool optimized = false;
 
+		// A clone of an optimized calculator shares the variables, expressions and node IO object
+		// of the original calculator (the system), and only has its own uneqs and evaluation state.
+		const Calculator* system = nullptr;
+		VarGroupState* state = nullptr;
+
 		NodeIOObject *iob1            = nullptr;
 		Node *localLastSuccessfulNode = nullptr; // should we store this one not locally, but in the calculator group? or threadgroup?
 		//Node* lastSuccessfulNode2     = nullptr;
@@ -66,20 +71,35 @@ namespace orchestracpp
 
 		int failedIndex = -100; // will be overwritten at initialisation
 		int nodeIDIndex = -101;
+		bool retryMode = false;
+		int iiaOnIndex = -102;  // node variable that records whether this node was solved with iia uneqs switched on
 		Node *orgNode = nullptr;
 		bool silent = false;
 
+		// the evaluation state after the last successful calculation, restored instead of calculating the last successful node again
+		VarGroupState lastSuccessfulState;
+		bool lastSuccessfulStateValid = false;
+
 	public:
 
 		Node* lastSuccessfulNode2 = nullptr;
 
+		int batchWidth = 0; // number of nodes (4 or 8) that calculateBatch iterates in lockstep (@batch:), 0 = no batches
+
 		virtual ~Calculator()
 		{
-			delete variables;
-			delete expressions;
+			if (system == nullptr)
+			{
+				delete variables;
+				delete expressions;
+				delete iob1;
+			}
+			else
+			{
+				delete state;
+			}
 			delete uneqs;
 
-			delete iob1;
 			//delete localLastSuccessfulNode;
 			//delete calculatorStopFlag;
 			//delete orgNode;
@@ -97,6 +117,11 @@ namespace orchestracpp
 		Calculator(const Calculator *oldCalculator);// throw(ReadException);
 
 	public:
+		/**
+		 * Returns an independent copy of this calculator, that can be used in another thread.
+		 * Once this calculator is optimized (after its first calculation) the copy shares its
+		 * compiled system and must not be used after this calculator is deleted.
+		 */
 		virtual Calculator *clone();
 
 	protected:
@@ -113,6 +138,23 @@ namespace orchestracpp
 
 		virtual bool calculate2(Node* const node, StopFlag* flag)/* throw(ReadException, ParserException, ExitException)*/;
 
+		/**
+		 * Calculates these nodes, batchWidth nodes at the time are first iterated in lockstep
+		 * with the compiled program in batch mode. Each node is then calculated with calculate,
+		 * which starts from the batch solution and takes care of the minerals, the initially
+		 * inactive uneqs and the nodes that failed or were left out of the batch.
+		 * Returns the number of successful nodes.
+		 */
+		virtual int calculateBatch(const std::vector<Node*>& nodes, StopFlag* flag);
+
+		/**
+		 * Determines which inputs of the compiled program have the same value in all these nodes
+		 * (static node variables, variables that are not copied from the node, or node variables
+		 * such as the temperature that happen to be equal), so the instructions that depend only
+		 * on these inputs are evaluated once for the batch. Does nothing before the first calculation.
+		 */
+		void shareBatchInputs(const std::vector<Node*>& nodes);
+
 		/**
 		 * This recursive method tries to calculate a node with a calculator it uses
 		 * the last successful node and the new node as input. It updates the last
@@ -133,9 +175,30 @@ namespace orchestracpp
 
 		virtual bool tryCalc(Node *last_successful_node, Node *node)/* throw(ParserException)*/;
 
+		/**
+		 * Solve a node with the initially inactive uneqs switched off first, and use
+		 * the result as start estimation for a calculation with these uneqs switched on.
+		 */
+		virtual bool bootstrapIIA(Node *node)/* throw(ParserException)*/;
+
+		/**
+		 * Lockstep iteration of at most batchWidth nodes, the unknowns of the lanes that
+		 * converged are copied into their nodes as start estimations.
+		 * Nodes that need other minerals than the first node, or the bootstrap of the
+		 * initially inactive uneqs, are left out of the batch.
+		 */
+		void solveBatch(Node* const* nodes, int nrNodes, StopFlag* flag);
+
 	protected:
 		virtual bool localCalculate(Node *node) /*throw(ParserException)*/;
 
+		/**
+		 * The variables the calculator needs: the unknowns and equations of the uneqs,
+		 * the global variables and the variables that are exchanged with the node.
+		 * Only the expressions these variables depend on are parsed.
+		 */
+		virtual std::vector<Var*> getRequiredVariables();
+
 		/**
 		 * copy the unknown variables from one node to the other
 		 * Nodes should both be from the same node type!
@@ -151,6 +214,29 @@ namespace orchestracpp
 		virtual std::vector<std::string>* getVariableNames();
 
 		virtual void addGlobalVariables(std::vector<std::string>*);
+
+		/**
+		 * In retry mode the calculator uses stronger settings (more iterations,
+		 * more levels of improving start estimations and central difference derivatives)
+		 * for nodes that failed before.
+		 */
+		virtual void setRetryMode(bool retry);
+
+		/**
+		 * Scale the tolerances of all equations, e.g. to solve the chemistry less accurately
+		 * in the early outer iterations of a sequential iterative transport coupling.
+		 * A factor of 1 restores the tolerances from the input file.
+		 */
+		virtual void setToleranceFactor(double factor);
+
+		/**
+		 * Changes the value of a parameter (a constant defined with @parameter:) of this calculator.
+		 * Only the parts of the compiled program that depend on this parameter are evaluated again,
+		 * the rest of the optimized system is kept. The clones of this calculator have their own
+		 * values: clones that are made afterwards take the new value, existing clones have to be
+		 * changed as well (NodeProcessor::setParameter).
+		 */
+		virtual void setParameter(const std::string& parameterName, double value);
 	};
 
 }
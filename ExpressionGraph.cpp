@@ -4,14 +4,18 @@
 #include "OrchestraReader.h"
 #include "OrchestraException.h"
 #include "ExpressionString.h"
+#include "ParserStringTokenizer.h"
+#include "stringhelper.h"
 #include <vector>
+#include <unordered_map>
+#include <algorithm>
 
 namespace orchestracpp
 {
 
 	ExpressionGraph::ExpressionGraph(VarGroup *variables)// throw(IOException)
 	{
-	   //this->variables = variables;
+	   this->variables = variables;
 	   parser = new Parser(variables);
 
 	}
@@ -51,6 +55,126 @@ namespace orchestracpp
 
 	}
 
+	void ExpressionGraph::readVectorExpression(OrchestraReader *infile)// throw(ParserException)
+	{
+	   std::string line = infile->readLine();
+	   //format: (<stage>,"<vector>=<expresssion>")
+
+	   int openingBracketPosition = (int)line.find('(');
+	   int startExpressionPosition = (int)line.find('"');
+	   int endExpressionPosition = (int)line.rfind('"');
+	   if ((openingBracketPosition < 0) || (startExpressionPosition < 0) || (startExpressionPosition == endExpressionPosition))
+	   {
+		   throw ParserException("Expected (<stage>,\"<vector>=<expression>\") in vector expression line: \n" + line);
+	   }
+
+	   ExpressionString expression(line.substr(startExpressionPosition + 1, endExpressionPosition - (startExpressionPosition + 1)));
+	   auto result = parser->vectors.find(expression.getResultVariableName());
+	   if (result == parser->vectors.end())
+	   {
+		   throw ParserException("The result of a vector expression should be a vector: \n" + line);
+	   }
+
+	   const std::vector<std::string> elements = result->second;
+	   for (size_t i = 0; i < elements.size(); i++)
+	   {
+		   addExpression2(line[openingBracketPosition + 1], elements[i] + "=" + elementExpression(expression.getExpression(), i, elements.size()));
+	   }
+	}
+
+	std::string ExpressionGraph::elementExpression(const std::string& expression, size_t element, size_t length)
+	{
+	   const std::string delimiters = " \t*/+-()^!<>&|,={}";
+	   std::string text;
+	   size_t position = 0;
+
+	   while (position < expression.length())
+	   {
+		   size_t end;
+		   std::string name;
+		   if (expression[position] == '{')
+		   {
+			   // a variable name between braces
+			   end = expression.find('}', position);
+			   if (end == std::string::npos)
+			   {
+				   throw ParserException("Missing } in expression: " + expression);
+			   }
+			   name = expression.substr(position + 1, end - position - 1);
+			   end++;
+		   }
+		   else if (delimiters.find(expression[position]) != std::string::npos)
+		   {
+			   text += expression[position++];
+			   continue;
+		   }
+		   else
+		   {
+			   end = std::min(expression.find_first_of(delimiters, position), expression.length());
+			   name = expression.substr(position, end - position);
+
+			   size_t open = expression.find_first_not_of(" \t", end);
+			   if (((name == "sum") || (name == "dot")) && (open != std::string::npos) && (expression[open] == '(') && (variables->get(name) == nullptr))
+			   {
+				   // sum() and dot() use whole vectors, so their arguments are copied unchanged
+				   int depth = 0;
+				   for (end = open; end < expression.length(); end++)
+				   {
+					   if (expression[end] == '(')
+					   {
+						   depth++;
+					   }
+					   else if ((expression[end] == ')') && (--depth == 0))
+					   {
+						   break;
+					   }
+				   }
+				   if (depth != 0)
+				   {
+					   throw ParserException("Missing ) in expression: " + expression);
+				   }
+				   end++;
+				   text += expression.substr(position, end - position);
+				   position = end;
+				   continue;
+			   }
+		   }
+
+		   const std::vector<std::string>* values = nullptr;
+		   bool isTable = false;
+		   auto vector = parser->vectors.find(name);
+		   auto table = parser->tables.find(name);
+		   if (vector != parser->vectors.end())
+		   {
+			   values = &vector->second;
+		   }
+		   else if (table != parser->tables.end())
+		   {
+			   values = &table->second;
+			   isTable = true;
+		   }
+
+		   if (values == nullptr)
+		   {
+			   text += expression.substr(position, end - position);
+		   }
+		   else if (values->size() != length)
+		   {
+			   throw ParserException("The vector or table " + name + " does not have " + std::to_string(length) + " elements in expression: " + expression);
+		   }
+		   else if (isTable)
+		   {
+			   text += "(" + (*values)[element] + ")";
+		   }
+		   else
+		   {
+			   text += "{" + (*values)[element] + "}";
+		   }
+		   position = end;
+	   }
+	   return text;
+	}
+
 	void ExpressionGraph::addExpression2(char stage, const std::string &expressionInputString)// throw(ParserException)
 	{
   	   ExpressionString* tempVar = new ExpressionString(expressionInputString);
@@ -95,32 +219,96 @@ namespace orchestracpp
 	   }
 	}
 
-	int ExpressionGraph::initialize()// throw(ParserException)
+	int ExpressionGraph::initialize(const std::vector<Var*>* requiredVariables)// throw(ParserException)
 	{
 	   int nrExpressions = 0;
 
-	   for (auto const &exp : stage1exp) {
-		   parser->addExpression(exp);
-		   nrExpressions++;
-	   }
-	   for (auto exp : stage2exp) {
-		   parser->addExpression(exp);
-		   nrExpressions++;
-	   }
-	   for (auto exp : stage3exp) {
-		   parser->addExpression(exp);
-		   nrExpressions++;
-	   }
-	   for (auto exp : stage4exp) {
-		   parser->addExpression(exp);
-		   nrExpressions++;
+	   std::vector<ExpressionString*> expressions;
+	   expressions.insert(expressions.end(), stage1exp.begin(), stage1exp.end());
+	   expressions.insert(expressions.end(), stage2exp.begin(), stage2exp.end());
+	   expressions.insert(expressions.end(), stage3exp.begin(), stage3exp.end());
+	   expressions.insert(expressions.end(), stage4exp.begin(), stage4exp.end());
+	   expressions.insert(expressions.end(), stage5exp.begin(), stage5exp.end());
+
+	   std::vector<bool> live(expressions.size(), true);
+	   if (eliminateDeadExpressions && (requiredVariables != nullptr)) {
+		   live = findLiveExpressions(expressions, *requiredVariables);
 	   }
-	   for (auto exp : stage5exp) {
-		   parser->addExpression(exp);
-		   nrExpressions++;
+
+	   nrSkippedExpressions = 0;
+	   for (size_t n = 0; n < expressions.size(); n++) {
+		   if (live[n]) {
+			   parser->addExpression(expressions[n]);
+			   nrExpressions++;
+		   }
+		   else {
+			   nrSkippedExpressions++;
+		   }
 	   }
 
 	   return nrExpressions;
 
 	}
+
+	std::vector<bool> ExpressionGraph::findLiveExpressions(const std::vector<ExpressionString*>& expressions, const std::vector<Var*>& requiredVariables)
+	{
+	   std::vector<bool> live(expressions.size(), false);
+	   std::vector<std::vector<int>> dependencies(expressions.size());
+	   std::unordered_map<Var*, int> lastExpression; // the expression that currently defines each variable
+	   std::vector<int> todo;
+
+	   for (size_t n = 0; n < expressions.size(); n++) {
+		   ParserStringTokenizer tokenizer(StringHelper::trim(expressions[n]->getExpression()));
+		   while (tokenizer.nextToken() != "") {
+			   Var* variable = tokenizer.isVariable(variables);
+			   if (variable != nullptr) {
+				   auto found = lastExpression.find(variable);
+				   if (found != lastExpression.end()) {
+					   dependencies[n].push_back(found->second);
+				   }
+			   }
+			   else if (tokenizer.getCurrentToken() == "print") {
+				   todo.push_back((int)n); // keep the output of print expressions
+			   }
+			   else {
+				   // sum() and dot() use all elements of a vector
+				   auto vector = parser->vectors.find(std::string(tokenizer.getCurrentToken()));
+				   if (vector != parser->vectors.end()) {
+					   for (auto& element : vector->second) {
+						   auto found = lastExpression.find(variables->get(element));
+						   if (found != lastExpression.end()) {
+							   dependencies[n].push_back(found->second);
+						   }
+					   }
+				   }
+			   }
+			   tokenizer.consume();
+		   }
+
+		   Var* result = variables->get(expressions[n]->getResultVariableName());
+		   if (result == nullptr) {
+			   todo.push_back((int)n); // the parser will report this one
+		   }
+		   else {
+			   lastExpression[result] = (int)n;
+		   }
+	   }
+
+	   for (auto v : requiredVariables) {
+		   auto found = lastExpression.find(v);
+		   if (found != lastExpression.end()) {
+			   todo.push_back(found->second);
+		   }
+	   }
+
+	   while (!todo.empty()) {
+		   int n = todo.back();
+		   todo.pop_back();
+		   if (!live[n]) {
+			   live[n] = true;
+			   todo.insert(todo.end(), dependencies[n].begin(), dependencies[n].end());
+		   }
+	   }
+	   return live;
+	}
 }
@@ -25,7 +25,7 @@ namespace orchestracpp
 	class ExpressionGraph final
 	{
     public:
-	   //VarGroup *variables;
+	   VarGroup *variables = nullptr;
 
 	   // a vector of expression string pointers
 	   //std::vector<ExpressionString*> expressionStack[5]; // = new std::vector<std::string*>[5];
@@ -39,6 +39,9 @@ namespace orchestracpp
 
 	   Parser *parser = nullptr;
 
+	   bool eliminateDeadExpressions = true; // switched off with @keepallexpressions:
+	   int nrSkippedExpressions = 0;
+
 	   ~ExpressionGraph()
 	   {
 		   delete parser;
@@ -48,6 +51,16 @@ namespace orchestracpp
 
 	   void readExpression(OrchestraReader *infile) /*throw(ParserException)*/;
 
+	   /**
+	    * An expression for all elements of a vector (@vcalc: keyword), with the same format
+	    * as readExpression. Element i of the result is calculated from element i of the
+	    * vectors and tables in the expression, so with vectors logc and logk and table nu,
+	    * (1,"logc = logk + nu*logh") gives one scalar expression per element.
+	    * The arguments of sum() and dot() are whole vectors, so these are not replaced by
+	    * an element and give the same scalar in each element expression.
+	    */
+	   void readVectorExpression(OrchestraReader *infile) /*throw(ParserException)*/;
+
 	   void addExpression2(char stage, const std::string &expressionInputString) /*throw(ParserException)*/;
 
 	   void addExpression(char stage, ExpressionString *expression) /*throw(ParserException)*/;
@@ -56,8 +69,24 @@ namespace orchestracpp
 
 	   /**
 	    * Add the expressions in the correct order to the expressionGraph
+	    * If required variables are given, only the expressions that these variables
+	    * depend on are parsed.
+	    */
+	   int initialize(const std::vector<Var*>* requiredVariables = nullptr)/* throw(ParserException)*/;
+
+	private:
+	   /**
+	    * Determine which expressions are needed to calculate the required variables.
+	    * A variable in an expression refers to the last expression before it with this
+	    * variable as result, as this is the memory node that the parser will use.
+	    */
+	   std::vector<bool> findLiveExpressions(const std::vector<ExpressionString*>& expressions, const std::vector<Var*>& requiredVariables);
+
+	   /**
+	    * The expression text for one element of a vector expression: vector names are replaced by
+	    * their element, table names by their number.
 	    */
-	   int initialize()/* throw(ParserException)*/;
+	   std::string elementExpression(const std::string& expression, size_t element, size_t length);
 
 	};
 }
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <string>
+#include <vector>
+#include <cstddef>
+
 namespace orchestracpp { class MemoryNode; }
 namespace orchestracpp { class Parser; }
+namespace orchestracpp { class ExpressionProgram; }
 
 namespace orchestracpp
 {
@@ -16,6 +21,15 @@ namespace orchestracpp
 	public:
 		bool isoptimized = false;
 
+		/**
+		 * Expression nodes are stored in the node storage of their parser: new (parser) PlusNode(...).
+		 * Variables are allocated with the normal new operator.
+		 */
+		static void* operator new(std::size_t size, Parser* parser);
+		static void operator delete(void* /*memory*/, Parser* /*parser*/) {}
+		static void* operator new(std::size_t size) { return ::operator new(size); }
+		static void operator delete(void* memory) { ::operator delete(memory); }
+
 		/** Evaluate this expression node recursively */
 		virtual double evaluate() = 0;
 
@@ -27,6 +41,21 @@ namespace orchestracpp
 
 		/** Recursively optimizes this expression node and returns an optimized alternative */
 		virtual ExpressionNode *optimize(Parser* parser) = 0;
+
+		/** Adds the instructions for this node to a program and returns the register with its result */
+		virtual int compile(ExpressionProgram* program) = 0;
+
+		/**
+		 * Returns a key that is equal for nodes of the same type with the same children,
+		 * used to share identical subexpressions. An empty key means the node is not shared.
+		 */
+		virtual std::string structuralKey() { return ""; }
+
+		/** Adds the addresses of the child pointers of this node, used to traverse and relink the graph */
+		virtual void getChildren(std::vector<ExpressionNode**>& children) = 0;
+
+		/** Creates a copy of this node in the node storage of the parser, variables return themselves */
+		virtual ExpressionNode* copy(Parser* parser) = 0;
 		
 		virtual ~ExpressionNode(){}
 
@@ -57,6 +86,12 @@ namespace orchestracpp
 		virtual bool constant();
 
 		virtual void optimize(Parser* parser);
+
+		virtual int compile(ExpressionProgram* program) = 0;
+
+		virtual std::string structuralKey();
+
+		virtual void getChildren(std::vector<ExpressionNode**>& children);
 	};
 
 
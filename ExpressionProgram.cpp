@@ -0,0 +1,1843 @@
+#include "ExpressionProgram.h"
+#include "Var.h"
+#include "IO.h"
+#include "FastMath.h"
+#include "OrchestraException.h"
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <fstream>
+#ifndef _WIN32
+#include <dlfcn.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cerrno>
+#endif
+
+namespace orchestracpp
+{
+
+	ExpressionProgram::ExpressionProgram()
+	{
+	}
+
+	int ExpressionProgram::addRoot(Var* var)
+	{
+		int reg = (var->memory == nullptr) ? compile(var) : compile(var->memory);
+		rootRegisters.push_back(reg);
+		return reg;
+	}
+
+	int ExpressionProgram::compile(ExpressionNode* node)
+	{
+		auto found = nodeRegisters.find(node);
+		if (found != nodeRegisters.end())
+		{
+			return found->second;
+		}
+		int reg = node->compile(this);
+		nodeRegisters[node] = reg;
+		return reg;
+	}
+
+	int ExpressionProgram::compile(BExpressionNode* node)
+	{
+		auto found = nodeRegisters.find(node);
+		if (found != nodeRegisters.end())
+		{
+			return found->second;
+		}
+		int reg = node->compile(this);
+		nodeRegisters[node] = reg;
+		return reg;
+	}
+
+	int ExpressionProgram::addConstant(double value)
+	{
+		registers.push_back(value);
+		constantRegisters.push_back((int)registers.size() - 1);
+		return (int)registers.size() - 1;
+	}
+
+	int ExpressionProgram::addInput(Var* var)
+	{
+		if (var->parameter)
+		{
+			// a parameter keeps its value until setParameter
+			registers.push_back(var->getIniValue());
+			parameterVars.push_back(var);
+			parameterRegisters.push_back((int)registers.size() - 1);
+			return (int)registers.size() - 1;
+		}
+
+		// the input registers start as NaN, so the first run loads all inputs
+		registers.push_back(std::numeric_limits<double>::quiet_NaN());
+		inputVars.push_back(var);
+		inputRegisters.push_back((int)registers.size() - 1);
+		return (int)registers.size() - 1;
+	}
+
+	int ExpressionProgram::addInstruction(Opcode opcode, int a, int b, int c)
+	{
+		registers.push_back(0);
+		int result = (int)registers.size() - 1;
+		instructions.push_back({ opcode, result, a, b, c });
+		return result;
+	}
+
+	int ExpressionProgram::addMultiPlus(int nrOperands, ExpressionNode** operandNodes, double* operandFactors)
+	{
+		// compile the operands first, so they precede this instruction
+		std::vector<int> operandRegisters(nrOperands);
+		for (int n = 0; n < nrOperands; n++)
+		{
+			operandRegisters[n] = compile(operandNodes[n]);
+		}
+
+		int first = (int)operands.size();
+		for (int n = 0; n < nrOperands; n++)
+		{
+			operands.push_back(operandRegisters[n]);
+			factors.push_back(operandFactors[n]);
+		}
+		return addInstruction(MULTIPLUS, first, nrOperands);
+	}
+
+	int ExpressionProgram::addMultiTimes(int nrOperands, ExpressionNode** operandNodes)
+	{
+		std::vector<int> operandRegisters(nrOperands);
+		for (int n = 0; n < nrOperands; n++)
+		{
+			operandRegisters[n] = compile(operandNodes[n]);
+		}
+
+		int first = (int)operands.size();
+		for (int n = 0; n < nrOperands; n++)
+		{
+			operands.push_back(operandRegisters[n]);
+			factors.push_back(1.0); // keeps operands and factors aligned
+		}
+		return addInstruction(MULTITIMES, first, nrOperands);
+	}
+
+	void ExpressionProgram::getOperands(const Instruction& instruction, std::vector<int>& result)
+	{
+		result.clear();
+		if ((instruction.opcode == MULTIPLUS) || (instruction.opcode == MULTITIMES))
+		{
+			for (int n = 0; n < instruction.b; n++)
+			{
+				result.push_back(operands[instruction.a + n]);
+			}
+			return;
+		}
+		if ((instruction.opcode == MASS_ACTION) || (instruction.opcode == MASS_BALANCE))
+		{
+			const std::vector<int>& columns = sparseBlocks[instruction.a].columns;
+			result.assign(columns.begin(), columns.end());
+			return;
+		}
+		if (instruction.a >= 0) result.push_back(instruction.a);
+		if (instruction.b >= 0) result.push_back(instruction.b);
+		if (instruction.c >= 0) result.push_back(instruction.c);
+	}
+
+	void ExpressionProgram::getResults(const Instruction& instruction, std::vector<int>& result)
+	{
+		if ((instruction.opcode == MASS_ACTION) || (instruction.opcode == MASS_BALANCE))
+		{
+			result = sparseBlocks[instruction.a].results;
+			return;
+		}
+		result.assign(1, instruction.result);
+	}
+
+	void ExpressionProgram::getDefinitions(std::vector<int>& definition)
+	{
+		// the instruction that calculates each register, -1 for the inputs and -2 for the constants
+		definition.assign(registers.size(), -1);
+		for (int reg : constantRegisters)
+		{
+			definition[reg] = -2;
+		}
+		std::vector<int> instructionResults;
+		for (size_t n = 0; n < instructions.size(); n++)
+		{
+			getResults(instructions[n], instructionResults);
+			for (int reg : instructionResults)
+			{
+				definition[reg] = (int)n;
+			}
+		}
+	}
+
+	void ExpressionProgram::linearize(int reg, const std::vector<int>& definition, SparseRow& row)
+	{
+		int n = definition[reg];
+		if (n == -2)
+		{
+			row.constant = registers[reg];
+			return;
+		}
+		if (n >= 0)
+		{
+			const Instruction& in = instructions[n];
+			switch (in.opcode)
+			{
+			case PLUS:
+				linearize(in.a, definition, row);
+				addTerm(in.b, 1.0, definition, row);
+				row.absorbed.push_back(n);
+				return;
+			case MINUS:
+				linearize(in.a, definition, row);
+				addTerm(in.b, -1.0, definition, row);
+				row.absorbed.push_back(n);
+				return;
+			case MULTIPLUS:
+				// same order of summation as the MULTIPLUS instruction
+				for (int k = in.b - 1; k >= 0; k--)
+				{
+					row.columns.push_back(operands[in.a + k]);
+					row.coefficients.push_back(factors[in.a + k]);
+					row.lastLeaf = std::max(row.lastLeaf, definition[operands[in.a + k]]);
+				}
+				row.absorbed.push_back(n);
+				return;
+			default:
+				break;
+			}
+		}
+		// the sum starts with 0 + this term
+		addTerm(reg, 1.0, definition, row);
+	}
+
+	void ExpressionProgram::addTerm(int reg, double sign, const std::vector<int>& definition, SparseRow& row)
+	{
+		int n = definition[reg];
+		double coefficient = sign;
+
+		// a - c * x is calculated as a + (-c) * x, which gives the same value
+		if ((n >= 0) && (instructions[n].opcode == TIMES))
+		{
+			const Instruction& in = instructions[n];
+			if (definition[in.a] == -2)
+			{
+				coefficient = sign * registers[in.a];
+				reg = in.b;
+				row.absorbed.push_back(n);
+			}
+			else if (definition[in.b] == -2)
+			{
+				coefficient = sign * registers[in.b];
+				reg = in.a;
+				row.absorbed.push_back(n);
+			}
+		}
+		row.columns.push_back(reg);
+		row.coefficients.push_back(coefficient);
+		row.lastLeaf = std::max(row.lastLeaf, definition[reg]);
+	}
+
+	void ExpressionProgram::getInputDependent(std::vector<bool>& inputDependent)
+	{
+		// the other registers depend only on parameters and constants
+		inputDependent.assign(registers.size(), false);
+		for (int reg : inputRegisters)
+		{
+			inputDependent[reg] = true;
+		}
+		std::vector<int> instructionOperands;
+		std::vector<int> instructionResults;
+		for (const Instruction& in : instructions)
+		{
+			getOperands(in, instructionOperands);
+			bool isInputDependent = false;
+			for (int reg : instructionOperands)
+			{
+				isInputDependent = isInputDependent || inputDependent[reg];
+			}
+			getResults(in, instructionResults);
+			for (int result : instructionResults)
+			{
+				inputDependent[result] = isInputDependent;
+			}
+		}
+	}
+
+	void ExpressionProgram::getInputDependencies(std::vector<std::vector<bool>>& dependencies)
+	{
+		dependencies.assign(registers.size(), std::vector<bool>(inputVars.size(), false));
+		for (size_t i = 0; i < inputVars.size(); i++)
+		{
+			dependencies[inputRegisters[i]][i] = true;
+		}
+		std::vector<int> instructionOperands;
+		std::vector<int> instructionResults;
+		std::vector<bool> instructionDependencies;
+		for (const Instruction& in : instructions)
+		{
+			getOperands(in, instructionOperands);
+			instructionDependencies.assign(inputVars.size(), false);
+			for (int reg : instructionOperands)
+			{
+				for (size_t i = 0; i < inputVars.size(); i++)
+				{
+					instructionDependencies[i] = instructionDependencies[i] || dependencies[reg][i];
+				}
+			}
+			getResults(in, instructionResults);
+			for (int result : instructionResults)
+			{
+				dependencies[result] = instructionDependencies;
+			}
+		}
+	}
+
+	void ExpressionProgram::fuseMassActions()
+	{
+		std::vector<int> definition;
+		getDefinitions(definition);
+
+		std::vector<std::vector<bool>> dependencies;
+		getInputDependencies(dependencies);
+
+		std::vector<SparseRow> rows;
+		for (size_t n = 0; n < instructions.size(); n++)
+		{
+			if ((instructions[n].opcode != POWER10) && (instructions[n].opcode != FAST_POWER10))
+			{
+				continue;
+			}
+
+			// The exponentials of parameters are left out, as they are only evaluated when a parameter changes.
+			// The rows are fused per set of unknowns they depend on, so a jacobian column only evaluates
+			// the rows of its unknown, and per set of inputs if they do not depend on an unknown,
+			// so these stay input-invariant (and shared between nodes if their inputs are).
+			const std::vector<bool>& inputs = dependencies[instructions[n].result];
+			std::vector<bool> unknowns(inputVars.size(), false);
+			for (size_t i = 0; i < inputVars.size(); i++)
+			{
+				unknowns[i] = inputs[i] && inputVars[i]->isUnknown;
+			}
+			bool isVariant = std::find(unknowns.begin(), unknowns.end(), true) != unknowns.end();
+			if (!isVariant && (std::find(inputs.begin(), inputs.end(), true) == inputs.end()))
+			{
+				continue;
+			}
+
+			SparseRow row;
+			row.instruction = (int)n;
+			row.dependencies = isVariant ? unknowns : inputs;
+			linearize(instructions[n].a, definition, row);
+			rows.push_back(row);
+		}
+		fuseRows(rows, true);
+	}
+
+	void ExpressionProgram::fuseMassBalances()
+	{
+		std::vector<int> definition;
+		getDefinitions(definition);
+
+		std::vector<bool> inputDependent;
+		getInputDependent(inputDependent);
+
+		// the roots that are sums, in the order of their instructions
+		std::vector<int> sums;
+		for (int reg : rootRegisters)
+		{
+			int n = definition[reg];
+			if ((n >= 0) && inputDependent[reg] && ((instructions[n].opcode == PLUS) || (instructions[n].opcode == MINUS) || (instructions[n].opcode == MULTIPLUS)))
+			{
+				sums.push_back(n);
+			}
+		}
+		std::sort(sums.begin(), sums.end());
+		sums.erase(std::unique(sums.begin(), sums.end()), sums.end());
+
+		std::vector<SparseRow> rows;
+		for (int n : sums)
+		{
+			SparseRow row;
+			row.instruction = n;
+			linearize(instructions[n].result, definition, row);
+			rows.push_back(row);
+		}
+		fuseRows(rows, false);
+	}
+
+	void ExpressionProgram::fuseRows(const std::vector<SparseRow>& rows, bool exponential)
+	{
+		if (rows.empty())
+		{
+			return;
+		}
+
+		// A block replaces its first row, a row joins the last block with the same dependencies
+		// if all its columns are calculated before that point. The other rows are calculated earlier
+		// than before, so their results are available for all their users.
+		std::vector<std::vector<int>> groups;
+		std::map<std::vector<bool>, int> lastGroup;
+		for (size_t r = 0; r < rows.size(); r++)
+		{
+			auto found = lastGroup.find(rows[r].dependencies);
+			if (found != lastGroup.end())
+			{
+				const SparseRow& first = rows[groups[found->second][0]];
+				if ((rows[r].lastLeaf < first.instruction) && (!exponential || (instructions[rows[r].instruction].opcode == instructions[first.instruction].opcode)))
+				{
+					groups[found->second].push_back((int)r);
+					continue;
+				}
+			}
+			lastGroup[rows[r].dependencies] = (int)groups.size();
+			groups.push_back(std::vector<int>(1, (int)r));
+		}
+
+		const int keep = -1;
+		const int moved = -2;
+		std::vector<int> replacement(instructions.size(), keep);
+		std::vector<bool> absorbed(instructions.size(), false);
+		for (const auto& group : groups)
+		{
+			SparseBlock block;
+			block.exponential = exponential;
+			block.fastMath = (instructions[rows[group[0]].instruction].opcode == FAST_POWER10);
+			block.rowStart.push_back(0);
+			for (int r : group)
+			{
+				const SparseRow& row = rows[r];
+				block.results.push_back(instructions[row.instruction].result);
+				block.constants.push_back(row.constant);
+				block.columns.insert(block.columns.end(), row.columns.begin(), row.columns.end());
+				block.coefficients.insert(block.coefficients.end(), row.coefficients.begin(), row.coefficients.end());
+				block.rowStart.push_back((int)block.columns.size());
+				replacement[row.instruction] = moved;
+				for (int n : row.absorbed)
+				{
+					absorbed[n] = true;
+				}
+			}
+			block.exponents.resize(group.size());
+			replacement[rows[group[0]].instruction] = (int)sparseBlocks.size();
+			sparseBlocks.push_back(block);
+		}
+
+		std::vector<Instruction> fused;
+		std::vector<bool> removable;
+		for (size_t n = 0; n < instructions.size(); n++)
+		{
+			if (replacement[n] >= 0)
+			{
+				fused.push_back({ exponential ? MASS_ACTION : MASS_BALANCE, instructions[n].result, replacement[n], -1, -1 });
+				removable.push_back(false);
+			}
+			else if (replacement[n] == keep)
+			{
+				fused.push_back(instructions[n]);
+				removable.push_back(absorbed[n]);
+			}
+		}
+
+		// remove the absorbed instructions that are not used anymore
+		std::vector<int> uses(registers.size(), 0);
+		std::vector<int> instructionOperands;
+		for (int reg : rootRegisters)
+		{
+			uses[reg]++;
+		}
+		for (const Instruction& in : fused)
+		{
+			getOperands(in, instructionOperands);
+			for (int reg : instructionOperands)
+			{
+				uses[reg]++;
+			}
+		}
+		std::vector<bool> removed(fused.size(), false);
+		for (int n = (int)fused.size() - 1; n >= 0; n--)
+		{
+			if (removable[n] && (uses[fused[n].result] == 0))
+			{
+				removed[n] = true;
+				getOperands(fused[n], instructionOperands);
+				for (int reg : instructionOperands)
+				{
+					uses[reg]--;
+				}
+			}
+		}
+
+		instructions.clear();
+		for (size_t n = 0; n < fused.size(); n++)
+		{
+			if (!removed[n])
+			{
+				instructions.push_back(fused[n]);
+			}
+		}
+	}
+
+	int ExpressionProgram::getNrBlocks(bool exponential)
+	{
+		int nrBlocks = 0;
+		for (const SparseBlock& block : sparseBlocks)
+		{
+			nrBlocks += (block.exponential == exponential) ? 1 : 0;
+		}
+		return nrBlocks;
+	}
+
+	int ExpressionProgram::getNrRows(bool exponential)
+	{
+		int nrRows = 0;
+		for (const SparseBlock& block : sparseBlocks)
+		{
+			nrRows += (block.exponential == exponential) ? (int)block.results.size() : 0;
+		}
+		return nrRows;
+	}
+
+	bool ExpressionProgram::prepareJacobian(const std::vector<int>& equations, const std::vector<int>& unknowns, const std::vector<bool>& logarithmic)
+	{
+		gradientSteps.clear();
+		gradientTerms.clear();
+		gradientCoefficients.clear();
+		equationSlots.clear();
+		jacobianSize = (int)unknowns.size();
+
+		GradientContext context;
+		getDefinitions(context.definition);
+		context.depends.assign(registers.size(), false);
+		context.unknownOf.assign(registers.size(), -1);
+		context.logarithmic = logarithmic;
+		context.slots.assign(registers.size(), -2);
+		for (size_t i = 0; i < unknowns.size(); i++)
+		{
+			context.depends[inputRegisters[unknowns[i]]] = true;
+			context.unknownOf[inputRegisters[unknowns[i]]] = (int)i;
+		}
+
+		// the registers that depend on these unknowns
+		std::vector<int> instructionOperands;
+		std::vector<int> instructionResults;
+		for (const Instruction& in : instructions)
+		{
+			getOperands(in, instructionOperands);
+			for (int reg : instructionOperands)
+			{
+				if (context.depends[reg])
+				{
+					getResults(in, instructionResults);
+					for (int result : instructionResults)
+					{
+						context.depends[result] = true;
+					}
+					break;
+				}
+			}
+		}
+
+		for (int reg : equations)
+		{
+			equationSlots.push_back(addGradient(reg, context));
+		}
+		if (!context.analytic)
+		{
+			gradientSteps.clear();
+			return false;
+		}
+		gradients.resize(gradientSteps.size() * unknowns.size());
+		return true;
+	}
+
+	int ExpressionProgram::addGradient(int reg, GradientContext& context)
+	{
+		if (context.slots[reg] != -2)
+		{
+			return context.slots[reg];
+		}
+		if (!context.depends[reg] || !context.analytic)
+		{
+			context.slots[reg] = -1;
+			return -1;
+		}
+
+		std::vector<int> terms;
+		std::vector<double> coefficients;
+		GradientScale scale = SCALE_NONE;
+		int scaleRegister = -1;
+		int unknown = context.unknownOf[reg];
+
+		// the gradient of a term is the coefficient times the gradient of its register
+		auto term = [&](int operand, double coefficient)
+		{
+			int slot = addGradient(operand, context);
+			if (slot >= 0)
+			{
+				terms.push_back(slot);
+				coefficients.push_back(coefficient);
+			}
+		};
+
+		if (unknown >= 0)
+		{
+			if (context.logarithmic[unknown])
+			{
+				// d x / d log10(x) = ln(10) * x
+				scale = SCALE_LN10_VALUE;
+				scaleRegister = reg;
+			}
+		}
+		else
+		{
+			int n = context.definition[reg];
+			const Instruction& in = instructions[n];
+			switch (in.opcode)
+			{
+			case MASS_ACTION:
+			case MASS_BALANCE:
+			{
+				// the row of the block that calculates this register
+				const SparseBlock& block = sparseBlocks[in.a];
+				size_t k = std::find(block.results.begin(), block.results.end(), reg) - block.results.begin();
+				for (int t = block.rowStart[k]; t < block.rowStart[k + 1]; t++)
+				{
+					term(block.columns[t], block.coefficients[t]);
+				}
+				if (block.exponential)
+				{
+					scale = SCALE_LN10_VALUE;
+					scaleRegister = reg;
+				}
+				break;
+			}
+			case MULTIPLUS:
+				for (int k = 0; k < in.b; k++)
+				{
+					term(operands[in.a + k], factors[in.a + k]);
+				}
+				break;
+			case PLUS:  term(in.a, 1.0); term(in.b, 1.0); break;
+			case MINUS: term(in.a, 1.0); term(in.b, -1.0); break;
+			case UMIN:  term(in.a, -1.0); break;
+			case TIMES:
+				// one of the factors has to be independent of the unknowns
+				if (context.depends[in.a] && context.depends[in.b])
+				{
+					context.analytic = false;
+					break;
+				}
+				term(context.depends[in.a] ? in.a : in.b, 1.0);
+				scale = SCALE_VALUE;
+				scaleRegister = context.depends[in.a] ? in.b : in.a;
+				break;
+			case DIVIDE:
+				if (context.depends[in.b])
+				{
+					context.analytic = false;
+					break;
+				}
+				term(in.a, 1.0);
+				scale = SCALE_INVERSE;
+				scaleRegister = in.b;
+				break;
+			case SQR:
+				term(in.a, 2.0);
+				scale = SCALE_VALUE;
+				scaleRegister = in.a;
+				break;
+			case SQRT:
+				term(in.a, 0.5);
+				scale = SCALE_INVERSE;
+				scaleRegister = reg;
+				break;
+			case POWER10:
+			case FAST_POWER10:
+				term(in.a, 1.0);
+				scale = SCALE_LN10_VALUE;
+				scaleRegister = reg;
+				break;
+			case LOG10:
+			case FAST_LOG10:
+				term(in.a, 1.0);
+				scale = SCALE_INVERSE_LN10_VALUE;
+				scaleRegister = in.a;
+				break;
+			case LOG:
+			case FAST_LOG:
+				term(in.a, 1.0);
+				scale = SCALE_INVERSE;
+				scaleRegister = in.a;
+				break;
+			case EXP:
+			case FAST_EXP:
+				term(in.a, 1.0);
+				scale = SCALE_VALUE;
+				scaleRegister = reg;
+				break;
+			default:
+				context.analytic = false;
+				break;
+			}
+			if (!context.analytic || terms.empty())
+			{
+				context.slots[reg] = -1;
+				return -1;
+			}
+		}
+		context.slots[reg] = addGradientStep(unknown, terms, coefficients, scale, scaleRegister);
+		return context.slots[reg];
+	}
+
+	int ExpressionProgram::addGradientStep(int unknown, const std::vector<int>& terms, const std::vector<double>& coefficients, GradientScale scale, int scaleRegister)
+	{
+		GradientStep step;
+		step.slot = (int)gradientSteps.size();
+		step.unknown = unknown;
+		step.firstTerm = (int)gradientTerms.size();
+		step.nrTerms = (int)terms.size();
+		step.scale = scale;
+		step.scaleRegister = scaleRegister;
+		gradientTerms.insert(gradientTerms.end(), terms.begin(), terms.end());
+		gradientCoefficients.insert(gradientCoefficients.end(), coefficients.begin(), coefficients.end());
+		gradientSteps.push_back(step);
+		return step.slot;
+	}
+
+	void ExpressionProgram::calculateJacobian(double* jacobian)
+	{
+		const int dim = jacobianSize;
+		const double ln10 = std::log(10.0);
+		double* g = gradients.data();
+		const double* r = registers.data();
+
+		// the steps are in the order of their dependencies, the gradients are dense vectors over the unknowns
+		for (const GradientStep& step : gradientSteps)
+		{
+			double* s = g + (size_t)step.slot * dim;
+			std::fill_n(s, dim, 0.0);
+			if (step.unknown >= 0)
+			{
+				s[step.unknown] = 1.0;
+			}
+			for (int t = step.firstTerm; t < step.firstTerm + step.nrTerms; t++)
+			{
+				const double* x = g + (size_t)gradientTerms[t] * dim;
+				double coefficient = gradientCoefficients[t];
+				for (int i = 0; i < dim; i++) s[i] += coefficient * x[i];
+			}
+
+			double scale = 1.0;
+			switch (step.scale)
+			{
+			case SCALE_NONE:               continue;
+			case SCALE_VALUE:              scale = r[step.scaleRegister]; break;
+			case SCALE_INVERSE:            scale = 1.0 / r[step.scaleRegister]; break;
+			case SCALE_LN10_VALUE:         scale = ln10 * r[step.scaleRegister]; break;
+			case SCALE_INVERSE_LN10_VALUE: scale = 1.0 / (ln10 * r[step.scaleRegister]); break;
+			}
+			for (int i = 0; i < dim; i++) s[i] *= scale;
+		}
+
+		for (size_t f = 0; f < equationSlots.size(); f++)
+		{
+			double* row = jacobian + f * dim;
+			if (equationSlots[f] < 0)
+			{
+				std::fill_n(row, dim, 0.0);
+			}
+			else
+			{
+				std::copy_n(g + (size_t)equationSlots[f] * dim, dim, row);
+			}
+		}
+	}
+
+	void ExpressionProgram::partitionInstructions()
+	{
+		// an instruction is iteration-variant if one of its operands depends on an unknown,
+		// and a parameter instruction if its operands depend only on parameters and constants
+		std::vector<bool> variant(registers.size(), false);
+		std::vector<bool> inputDependent(registers.size(), false);
+		for (size_t i = 0; i < inputVars.size(); i++)
+		{
+			variant[inputRegisters[i]] = inputVars[i]->isUnknown;
+			inputDependent[inputRegisters[i]] = true;
+		}
+		std::vector<int> instructionOperands;
+		std::vector<int> instructionResults;
+		std::vector<Instruction> parameterPart;
+		std::vector<Instruction> invariantPart;
+		std::vector<Instruction> variantPart;
+		for (const Instruction& in : instructions)
+		{
+			getOperands(in, instructionOperands);
+			bool isVariant = false;
+			bool isInputDependent = false;
+			for (int reg : instructionOperands)
+			{
+				isVariant = isVariant || variant[reg];
+				isInputDependent = isInputDependent || inputDependent[reg];
+			}
+			getResults(in, instructionResults);
+			for (int result : instructionResults)
+			{
+				variant[result] = isVariant;
+				inputDependent[result] = isInputDependent;
+			}
+			if (isVariant)
+			{
+				variantPart.push_back(in);
+			}
+			else
+			{
+				(isInputDependent ? invariantPart : parameterPart).push_back(in);
+			}
+		}
+
+		// the invariant instructions never use a variant result, and the parameter instructions
+		// only use parameter results, so the order stays topological
+		nrParameterInstructions = (int)parameterPart.size();
+		nrSharedInstructions = nrParameterInstructions;
+		nrInvariantInstructions = nrParameterInstructions + (int)invariantPart.size();
+		instructions = parameterPart;
+		instructions.insert(instructions.end(), invariantPart.begin(), invariantPart.end());
+		instructions.insert(instructions.end(), variantPart.begin(), variantPart.end());
+	}
+
+	void ExpressionProgram::finish()
+	{
+		if (massActionKernels)
+		{
+			fuseMassActions();
+			fuseMassBalances();
+		}
+		partitionInstructions();
+
+		inputDependents.assign(inputVars.size(), std::vector<int>());
+		inputResults.assign(inputVars.size(), std::vector<int>());
+		inputHasDependents.assign(inputVars.size(), false);
+
+		std::vector<bool> depends(registers.size());
+		std::vector<int> instructionOperands;
+		std::vector<int> instructionResults;
+
+		// only the unknowns are changed one at a time, the other inputs always trigger a full run
+		for (size_t i = 0; i < inputVars.size(); i++)
+		{
+			if (!inputVars[i]->isUnknown)
+			{
+				continue;
+			}
+			inputHasDependents[i] = true;
+
+			std::fill(depends.begin(), depends.end(), false);
+			depends[inputRegisters[i]] = true;
+
+			for (size_t n = 0; n < instructions.size(); n++)
+			{
+				getOperands(instructions[n], instructionOperands);
+				for (int reg : instructionOperands)
+				{
+					if (depends[reg])
+					{
+						getResults(instructions[n], instructionResults);
+						for (int result : instructionResults)
+						{
+							depends[result] = true;
+						}
+						inputDependents[i].push_back((int)n);
+						inputResults[i].insert(inputResults[i].end(), instructionResults.begin(), instructionResults.end());
+						break;
+					}
+				}
+			}
+		}
+
+		parameterDependents.assign(parameterVars.size(), std::vector<int>());
+		for (size_t p = 0; p < parameterVars.size(); p++)
+		{
+			std::fill(depends.begin(), depends.end(), false);
+			depends[parameterRegisters[p]] = true;
+
+			for (int n = 0; n < nrParameterInstructions; n++)
+			{
+				getOperands(instructions[n], instructionOperands);
+				for (int reg : instructionOperands)
+				{
+					if (depends[reg])
+					{
+						getResults(instructions[n], instructionResults);
+						for (int result : instructionResults)
+						{
+							depends[result] = true;
+						}
+						parameterDependents[p].push_back(n);
+						break;
+					}
+				}
+			}
+		}
+		changedInputs.reserve(inputVars.size());
+		marked.assign(instructions.size(), 0);
+		sharedInputs.assign(inputVars.size(), false);
+	}
+
+	void ExpressionProgram::selectPlan(const std::vector<int>& equations)
+	{
+		if (!usePlans || (nativeFunction != nullptr))
+		{
+			return;
+		}
+
+		std::vector<int> key(equations);
+		std::sort(key.begin(), key.end());
+		key.erase(std::unique(key.begin(), key.end()), key.end());
+
+		// the registers may still hold the values of the previous node, the guards are checked again during the run
+		int selected = -1;
+		for (size_t p = 0; (selected < 0) && (p < plans.size()); p++)
+		{
+			if (plans[p].equations != key)
+			{
+				continue;
+			}
+			bool holds = true;
+			for (const auto& guard : plans[p].guards)
+			{
+				holds = holds && ((registers[instructions[guard.first].a] != 0) == guard.second);
+			}
+			selected = holds ? (int)p : -1;
+		}
+		if ((selected < 0) && (plans.size() < maxNrPlans))
+		{
+			buildPlan(key);
+			selected = (int)plans.size() - 1;
+		}
+
+		if ((selected != currentPlan) && planRan)
+		{
+			refreshVariant = true;
+		}
+		currentPlan = selected;
+	}
+
+	void ExpressionProgram::buildPlan(const std::vector<int>& equations)
+	{
+		std::vector<int> definition;
+		getDefinitions(definition);
+
+		Plan plan;
+		plan.equations = equations;
+		plan.guardOf.assign(instructions.size(), -1);
+
+		// the iteration-variant instructions these equations depend on, only through the branches taken
+		std::vector<bool> needed(instructions.size(), false);
+		std::vector<int> pending(equations);
+		std::vector<int> instructionOperands;
+		while (!pending.empty())
+		{
+			int n = definition[pending.back()];
+			pending.pop_back();
+			if ((n < nrInvariantInstructions) || needed[n])
+			{
+				continue;
+			}
+			needed[n] = true;
+
+			const Instruction& in = instructions[n];
+			if (in.opcode == SELECT)
+			{
+				bool condition = (registers[in.a] != 0);
+				plan.guardOf[n] = condition ? 1 : 0;
+				plan.guards.push_back({ n, condition });
+				pending.push_back(in.a);
+				pending.push_back(condition ? in.b : in.c);
+				continue;
+			}
+			getOperands(in, instructionOperands);
+			pending.insert(pending.end(), instructionOperands.begin(), instructionOperands.end());
+		}
+
+		plan.inputDependents.resize(inputDependents.size());
+		for (size_t i = 0; i < inputDependents.size(); i++)
+		{
+			for (int n : inputDependents[i])
+			{
+				if (needed[n])
+				{
+					plan.inputDependents[i].push_back(n);
+				}
+			}
+		}
+		plans.push_back(plan);
+	}
+
+	void ExpressionProgram::runPlan()
+	{
+		const Plan& plan = plans[currentPlan];
+		planRan = true;
+
+		bool holds = true;
+		if (changedInputs.size() == 1)
+		{
+			for (int n : plan.inputDependents[changedInputs[0]])
+			{
+				holds = holds && executeGuarded(plan, n);
+			}
+		}
+		else
+		{
+			for (int i : changedInputs)
+			{
+				for (int n : plan.inputDependents[i])
+				{
+					marked[n] = 1;
+				}
+			}
+			for (size_t n = nrInvariantInstructions; n < instructions.size(); n++)
+			{
+				if (marked[n])
+				{
+					holds = holds && executeGuarded(plan, (int)n);
+					marked[n] = 0;
+				}
+			}
+		}
+
+		if (!holds)
+		{
+			// a condition flipped, the branch that is now taken is not in the plan
+			currentPlan = -1;
+			executeVariant();
+		}
+	}
+
+	bool ExpressionProgram::executeGuarded(const Plan& plan, int n)
+	{
+		const Instruction& in = instructions[n];
+		if ((plan.guardOf[n] >= 0) && ((registers[in.a] != 0) != (plan.guardOf[n] == 1)))
+		{
+			return false;
+		}
+		execute(in);
+		return true;
+	}
+
+	void ExpressionProgram::executeVariant()
+	{
+		for (size_t n = nrInvariantInstructions; n < instructions.size(); n++)
+		{
+			execute(instructions[n]);
+		}
+		refreshVariant = false;
+		planRan = false;
+	}
+
+	void ExpressionProgram::setSharedInputs(const std::vector<bool>& shared)
+	{
+		if (shared == sharedInputs)
+		{
+			return;
+		}
+		sharedInputs = shared;
+
+		// Only the input-invariant part after the parameter instructions is reordered, so the instruction
+		// numbers of the parameter part (parameterDependents) and the iteration-variant part stay the same.
+		std::vector<bool> nodeDependent(registers.size(), false);
+		for (size_t i = 0; i < inputVars.size(); i++)
+		{
+			nodeDependent[inputRegisters[i]] = !sharedInputs[i];
+		}
+		std::vector<int> instructionOperands;
+		std::vector<int> instructionResults;
+		std::vector<Instruction> sharedPart;
+		std::vector<Instruction> nodePart;
+		for (int n = nrParameterInstructions; n < nrInvariantInstructions; n++)
+		{
+			getOperands(instructions[n], instructionOperands);
+			bool isNodeDependent = false;
+			for (int reg : instructionOperands)
+			{
+				isNodeDependent = isNodeDependent || nodeDependent[reg];
+			}
+			getResults(instructions[n], instructionResults);
+			for (int result : instructionResults)
+			{
+				nodeDependent[result] = isNodeDependent;
+			}
+			(isNodeDependent ? nodePart : sharedPart).push_back(instructions[n]);
+		}
+		nrSharedInstructions = nrParameterInstructions + (int)sharedPart.size();
+		std::copy(sharedPart.begin(), sharedPart.end(), instructions.begin() + nrParameterInstructions);
+		std::copy(nodePart.begin(), nodePart.end(), instructions.begin() + nrSharedInstructions);
+
+		sharedChanged = true;
+		batchSharedChanged = true;
+	}
+
+	void ExpressionProgram::setParameter(Var* var, double value)
+	{
+		for (size_t p = 0; p < parameterVars.size(); p++)
+		{
+			if ((parameterVars[p] != var) || (registers[parameterRegisters[p]] == value))
+			{
+				continue;
+			}
+			registers[parameterRegisters[p]] = value;
+			for (int n : parameterDependents[p])
+			{
+				execute(instructions[n]);
+			}
+
+			// the lanes of the parameter registers hold the same value
+			if (batchWidth > 0)
+			{
+				std::vector<int> changed(1, parameterRegisters[p]);
+				std::vector<int> instructionResults;
+				for (int n : parameterDependents[p])
+				{
+					getResults(instructions[n], instructionResults);
+					changed.insert(changed.end(), instructionResults.begin(), instructionResults.end());
+				}
+				for (int reg : changed)
+				{
+					std::fill_n(batchRegisters.begin() + (size_t)reg * batchWidth, batchWidth, registers[reg]);
+				}
+			}
+
+			parametersChanged = true;
+			sharedChanged = true;
+			batchSharedChanged = true;
+		}
+	}
+
+	void ExpressionProgram::run()
+	{
+		changedInputs.clear();
+		for (size_t i = 0; i < inputVars.size(); i++)
+		{
+			double value = inputVars[i]->getIniValue();
+			if (value != registers[inputRegisters[i]])
+			{
+				registers[inputRegisters[i]] = value;
+				changedInputs.push_back((int)i);
+				sharedChanged = sharedChanged || sharedInputs[i];
+			}
+		}
+
+		// a plan change may need the instructions the previous plan skipped, also without a changed input
+		if (!firstRun && !parametersChanged && !refreshVariant && changedInputs.empty())
+		{
+			return;
+		}
+
+		bool onlyUnknownsChanged = !firstRun && !parametersChanged;
+		for (int i : changedInputs)
+		{
+			onlyUnknownsChanged = onlyUnknownsChanged && inputHasDependents[i];
+		}
+
+		if (nativeFunction != nullptr)
+		{
+			if (onlyUnknownsChanged && (nativeVariantFunction != nullptr))
+			{
+				nativeVariantFunction(registers.data());
+				return;
+			}
+			nativeFunction(registers.data());
+			firstRun = false;
+			sharedChanged = false;
+			parametersChanged = false;
+			return;
+		}
+
+		if (onlyUnknownsChanged)
+		{
+			if (refreshVariant)
+			{
+				executeVariant();
+				return;
+			}
+			if (currentPlan >= 0)
+			{
+				runPlan();
+				return;
+			}
+
+			if (changedInputs.size() == 1)
+			{
+				for (int n : inputDependents[changedInputs[0]])
+				{
+					execute(instructions[n]);
+				}
+				return;
+			}
+
+			// e.g. the previous unknown was reset and the next one offset during the jacobian calculation
+			for (int i : changedInputs)
+			{
+				for (int n : inputDependents[i])
+				{
+					marked[n] = 1;
+				}
+			}
+			for (size_t n = nrInvariantInstructions; n < instructions.size(); n++)
+			{
+				if (marked[n])
+				{
+					execute(instructions[n]);
+					marked[n] = 0;
+				}
+			}
+			return;
+		}
+
+		// the parameter instructions are only executed again by setParameter, and
+		// the shared instructions still hold the values for the current shared inputs
+		size_t first = firstRun ? 0 : (sharedChanged ? nrParameterInstructions : nrSharedInstructions);
+		for (size_t n = first; n < instructions.size(); n++)
+		{
+			execute(instructions[n]);
+		}
+		firstRun = false;
+		sharedChanged = false;
+		parametersChanged = false;
+		refreshVariant = false;
+		planRan = false;
+	}
+
+	void ExpressionProgram::saveCentral()
+	{
+		run();
+		centralRegisters = registers;
+	}
+
+	void ExpressionProgram::restoreCentral(int input)
+	{
+		if (input < 0)
+		{
+			return;
+		}
+		registers[inputRegisters[input]] = centralRegisters[inputRegisters[input]];
+		for (int reg : inputResults[input])
+		{
+			registers[reg] = centralRegisters[reg];
+		}
+	}
+
+	void ExpressionProgram::execute(const Instruction& in)
+	{
+		double* r = registers.data();
+
+		switch (in.opcode)
+		{
+		case PLUS:    r[in.result] = r[in.a] + r[in.b]; break;
+		case MINUS:   r[in.result] = r[in.a] - r[in.b]; break;
+		case TIMES:   r[in.result] = r[in.a] * r[in.b]; break;
+		case DIVIDE:  r[in.result] = r[in.a] / r[in.b]; break;
+		case UMIN:    r[in.result] = -r[in.a]; break;
+		case ABS:     r[in.result] = std::abs(r[in.a]); break;
+		case MAX:     r[in.result] = (r[in.a] > r[in.b]) ? r[in.a] : r[in.b]; break;
+		case MIN:     r[in.result] = (r[in.a] < r[in.b]) ? r[in.a] : r[in.b]; break;
+		case POWER:   r[in.result] = std::pow(r[in.a], r[in.b]); break;
+		case POWER10: r[in.result] = std::pow(10, r[in.a]); break;
+		case SQR:     r[in.result] = r[in.a] * r[in.a]; break;
+		case SQRT:    r[in.result] = std::sqrt(r[in.a]); break;
+		case LOG:     r[in.result] = std::log(r[in.a]); break;
+		case LOG10:   r[in.result] = std::log10(r[in.a]); break;
+		case EXP:     r[in.result] = std::exp(r[in.a]); break;
+		case SIN:     r[in.result] = std::sin(r[in.a]); break;
+		case COS:     r[in.result] = std::cos(r[in.a]); break;
+		case TAN:     r[in.result] = std::tan(r[in.a]); break;
+		case SINH:    r[in.result] = std::sinh(r[in.a]); break;
+		case COSH:    r[in.result] = std::cosh(r[in.a]); break;
+		case TANH:    r[in.result] = std::tanh(r[in.a]); break;
+		case ATAN:    r[in.result] = std::atan(r[in.a]); break;
+		case FAST_POWER10: r[in.result] = FastMath::exp10(r[in.a]); break;
+		case FAST_LOG:     r[in.result] = FastMath::log(r[in.a]); break;
+		case FAST_LOG10:   r[in.result] = FastMath::log10(r[in.a]); break;
+		case FAST_EXP:     r[in.result] = FastMath::exp(r[in.a]); break;
+		case MULTIPLUS:
+		{
+			// same order of summation as the MultiPlusNode
+			double value = 0.0;
+			for (int n = in.b - 1; n >= 0; n--)
+			{
+				value = value + (factors[in.a + n] * r[operands[in.a + n]]);
+			}
+			r[in.result] = value;
+			break;
+		}
+		case MULTITIMES:
+		{
+			double value = r[operands[in.a]];
+			for (int n = 1; n < in.b; n++)
+			{
+				value = value * r[operands[in.a + n]];
+			}
+			r[in.result] = value;
+			break;
+		}
+		case EQ:      r[in.result] = (r[in.a] == r[in.b]) ? 1 : 0; break;
+		case LT:      r[in.result] = (r[in.a] <  r[in.b]) ? 1 : 0; break;
+		case GT:      r[in.result] = (r[in.a] >  r[in.b]) ? 1 : 0; break;
+		case LE:      r[in.result] = (r[in.a] <= r[in.b]) ? 1 : 0; break;
+		case GE:      r[in.result] = (r[in.a] >= r[in.b]) ? 1 : 0; break;
+		case NOT:     r[in.result] = (r[in.a] != 0) ? 0 : 1; break;
+		case SELECT:  r[in.result] = (r[in.a] != 0) ? r[in.b] : r[in.c]; break;
+		case MASS_ACTION:
+		case MASS_BALANCE: executeSparseBlock(sparseBlocks[in.a]); break;
+		}
+	}
+
+	void ExpressionProgram::executeSparseBlock(SparseBlock& block)
+	{
+		double* r = registers.data();
+		double* exponents = block.exponents.data();
+		int nrRows = (int)block.results.size();
+
+		// the matrix times the columns (the log activities or the concentrations), in the order of the original expressions
+		for (int k = 0; k < nrRows; k++)
+		{
+			double value = block.constants[k];
+			for (int t = block.rowStart[k]; t < block.rowStart[k + 1]; t++)
+			{
+				value = value + (block.coefficients[t] * r[block.columns[t]]);
+			}
+			exponents[k] = value;
+		}
+
+		if (block.exponential && block.fastMath)
+		{
+			FastMath::exp10(exponents, exponents, nrRows);
+		}
+		else if (block.exponential)
+		{
+			for (int k = 0; k < nrRows; k++)
+			{
+				exponents[k] = std::pow(10, exponents[k]);
+			}
+		}
+
+		for (int k = 0; k < nrRows; k++)
+		{
+			r[block.results[k]] = exponents[k];
+		}
+	}
+
+	void ExpressionProgram::initBatch(int width)
+	{
+		if ((width != 4) && (width != 8))
+		{
+			throw OrchestraException("The batch width should be 4 or 8, not " + std::to_string(width));
+		}
+		batchWidth = width;
+		batchSharedChanged = true;
+		batchParametersChanged = true;
+
+		// all lanes start with the current values, so the constants are in each lane
+		batchRegisters.resize(registers.size() * width);
+		for (size_t reg = 0; reg < registers.size(); reg++)
+		{
+			std::fill_n(batchRegisters.begin() + reg * width, width, registers[reg]);
+		}
+	}
+
+	void ExpressionProgram::loadBatchInputs(int lane)
+	{
+		for (size_t i = 0; i < inputVars.size(); i++)
+		{
+			double& input = batchRegisters[(size_t)inputRegisters[i] * batchWidth + lane];
+			double value = inputVars[i]->getIniValue();
+			batchSharedChanged = batchSharedChanged || (sharedInputs[i] && (value != input));
+			input = value;
+		}
+	}
+
+	void ExpressionProgram::runBatch()
+	{
+		int first = batchParametersChanged ? 0 : (batchSharedChanged ? nrParameterInstructions : nrSharedInstructions);
+		if (batchWidth == 8)
+		{
+			runBatch<8>(nullptr, first);
+		}
+		else if (batchWidth == 4)
+		{
+			runBatch<4>(nullptr, first);
+		}
+		else
+		{
+			throw OrchestraException("runBatch was called before initBatch");
+		}
+		batchSharedChanged = false;
+		batchParametersChanged = false;
+	}
+
+	void ExpressionProgram::runBatch(int changedInput)
+	{
+		if (!inputHasDependents[changedInput])
+		{
+			// not an unknown, so all instructions may depend on it
+			batchSharedChanged = true;
+			runBatch();
+		}
+		else if (batchWidth == 8)
+		{
+			runBatch<8>(&inputDependents[changedInput]);
+		}
+		else if (batchWidth == 4)
+		{
+			runBatch<4>(&inputDependents[changedInput]);
+		}
+		else
+		{
+			throw OrchestraException("runBatch was called before initBatch");
+		}
+	}
+
+	void ExpressionProgram::runBatchVariant()
+	{
+		if (batchWidth == 8)
+		{
+			runBatch<8>(nullptr, nrInvariantInstructions);
+		}
+		else if (batchWidth == 4)
+		{
+			runBatch<4>(nullptr, nrInvariantInstructions);
+		}
+		else
+		{
+			throw OrchestraException("runBatchVariant was called before initBatch");
+		}
+	}
+
+	template <int W>
+	void ExpressionProgram::runBatch(const std::vector<int>* selection, int first)
+	{
+		if (selection == nullptr)
+		{
+			for (size_t n = first; n < instructions.size(); n++)
+			{
+				executeBatch<W>(instructions[n]);
+			}
+			return;
+		}
+		for (int n : *selection)
+		{
+			executeBatch<W>(instructions[n]);
+		}
+	}
+
+	// Each lane is calculated with exactly the same operations as execute, so a lane
+	// gives the same value as a scalar run with the inputs of that lane
+	template <int W>
+	void ExpressionProgram::executeBatch(const Instruction& in)
+	{
+		double* base = batchRegisters.data();
+		double* r = base + (size_t)in.result * W;
+
+		if ((in.opcode == MASS_ACTION) || (in.opcode == MASS_BALANCE))
+		{
+			const SparseBlock& block = sparseBlocks[in.a];
+			for (size_t k = 0; k < block.results.size(); k++)
+			{
+				r = base + (size_t)block.results[k] * W;
+				for (int l = 0; l < W; l++) r[l] = block.constants[k];
+				for (int t = block.rowStart[k]; t < block.rowStart[k + 1]; t++)
+				{
+					const double* x = base + (size_t)block.columns[t] * W;
+					double coefficient = block.coefficients[t];
+					for (int l = 0; l < W; l++) r[l] = r[l] + (coefficient * x[l]);
+				}
+				if (!block.exponential)
+				{
+					continue;
+				}
+				if (block.fastMath)
+				{
+					FastMath::exp10(r, r, W);
+				}
+				else
+				{
+					for (int l = 0; l < W; l++) r[l] = std::pow(10, r[l]);
+				}
+			}
+			return;
+		}
+
+		if ((in.opcode == MULTIPLUS) || (in.opcode == MULTITIMES))
+		{
+			const int* operand = &operands[in.a];
+			const double* factor = &factors[in.a];
+			if (in.opcode == MULTIPLUS)
+			{
+				for (int l = 0; l < W; l++) r[l] = 0.0;
+				for (int n = in.b - 1; n >= 0; n--)
+				{
+					const double* x = base + (size_t)operand[n] * W;
+					for (int l = 0; l < W; l++) r[l] = r[l] + (factor[n] * x[l]);
+				}
+				return;
+			}
+			const double* x = base + (size_t)operand[0] * W;
+			for (int l = 0; l < W; l++) r[l] = x[l];
+			for (int n = 1; n < in.b; n++)
+			{
+				x = base + (size_t)operand[n] * W;
+				for (int l = 0; l < W; l++) r[l] = r[l] * x[l];
+			}
+			return;
+		}
+
+		const double* a = base + (size_t)in.a * W;
+		const double* b = (in.b >= 0) ? base + (size_t)in.b * W : a;
+		const double* c = (in.c >= 0) ? base + (size_t)in.c * W : a;
+
+		switch (in.opcode)
+		{
+		case PLUS:    for (int l = 0; l < W; l++) r[l] = a[l] + b[l]; break;
+		case MINUS:   for (int l = 0; l < W; l++) r[l] = a[l] - b[l]; break;
+		case TIMES:   for (int l = 0; l < W; l++) r[l] = a[l] * b[l]; break;
+		case DIVIDE:  for (int l = 0; l < W; l++) r[l] = a[l] / b[l]; break;
+		case UMIN:    for (int l = 0; l < W; l++) r[l] = -a[l]; break;
+		case ABS:     for (int l = 0; l < W; l++) r[l] = std::abs(a[l]); break;
+		case MAX:     for (int l = 0; l < W; l++) r[l] = (a[l] > b[l]) ? a[l] : b[l]; break;
+		case MIN:     for (int l = 0; l < W; l++) r[l] = (a[l] < b[l]) ? a[l] : b[l]; break;
+		case POWER:   for (int l = 0; l < W; l++) r[l] = std::pow(a[l], b[l]); break;
+		case POWER10: for (int l = 0; l < W; l++) r[l] = std::pow(10, a[l]); break;
+		case SQR:     for (int l = 0; l < W; l++) r[l] = a[l] * a[l]; break;
+		case SQRT:    for (int l = 0; l < W; l++) r[l] = std::sqrt(a[l]); break;
+		case LOG:     for (int l = 0; l < W; l++) r[l] = std::log(a[l]); break;
+		case LOG10:   for (int l = 0; l < W; l++) r[l] = std::log10(a[l]); break;
+		case EXP:     for (int l = 0; l < W; l++) r[l] = std::exp(a[l]); break;
+		case SIN:     for (int l = 0; l < W; l++) r[l] = std::sin(a[l]); break;
+		case COS:     for (int l = 0; l < W; l++) r[l] = std::cos(a[l]); break;
+		case TAN:     for (int l = 0; l < W; l++) r[l] = std::tan(a[l]); break;
+		case SINH:    for (int l = 0; l < W; l++) r[l] = std::sinh(a[l]); break;
+		case COSH:    for (int l = 0; l < W; l++) r[l] = std::cosh(a[l]); break;
+		case TANH:    for (int l = 0; l < W; l++) r[l] = std::tanh(a[l]); break;
+		case ATAN:    for (int l = 0; l < W; l++) r[l] = std::atan(a[l]); break;
+		// the array kernels give the same results as the scalar kernels
+		case FAST_POWER10: FastMath::exp10(a, r, W); break;
+		case FAST_LOG:     FastMath::log(a, r, W); break;
+		case FAST_LOG10:   FastMath::log10(a, r, W); break;
+		case FAST_EXP:     FastMath::exp(a, r, W); break;
+		case EQ:      for (int l = 0; l < W; l++) r[l] = (a[l] == b[l]) ? 1 : 0; break;
+		case LT:      for (int l = 0; l < W; l++) r[l] = (a[l] <  b[l]) ? 1 : 0; break;
+		case GT:      for (int l = 0; l < W; l++) r[l] = (a[l] >  b[l]) ? 1 : 0; break;
+		case LE:      for (int l = 0; l < W; l++) r[l] = (a[l] <= b[l]) ? 1 : 0; break;
+		case GE:      for (int l = 0; l < W; l++) r[l] = (a[l] >= b[l]) ? 1 : 0; break;
+		case NOT:     for (int l = 0; l < W; l++) r[l] = (a[l] != 0) ? 0 : 1; break;
+		case SELECT:  for (int l = 0; l < W; l++) r[l] = (a[l] != 0) ? b[l] : c[l]; break;
+		default: break;
+		}
+	}
+
+	// 64 bit FNV-1a hash, this has to give the same value on each platform and run
+	static unsigned long long hashString(const std::string& text)
+	{
+		unsigned long long hash = 14695981039346656037ULL;
+		for (unsigned char c : text)
+		{
+			hash ^= c;
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	static std::string hexString(unsigned long long value)
+	{
+		char buffer[20];
+		std::snprintf(buffer, sizeof(buffer), "%016llx", value);
+		return buffer;
+	}
+
+	// a literal that reproduces the exact double value
+	static std::string literal(double value)
+	{
+		if (std::isnan(value))
+		{
+			return "NAN";
+		}
+		if (std::isinf(value))
+		{
+			return (value > 0) ? "INFINITY" : "(-INFINITY)";
+		}
+		char buffer[40];
+		std::snprintf(buffer, sizeof(buffer), "%a", value);
+		return std::string("(") + buffer + ")";
+	}
+
+	std::string ExpressionProgram::generateSource()
+	{
+		// constants are written as literals, so the compiler can fold them
+		std::vector<std::string> names(registers.size());
+		for (size_t n = 0; n < registers.size(); n++)
+		{
+			names[n] = "r[" + std::to_string(n) + "]";
+		}
+		for (int reg : constantRegisters)
+		{
+			names[reg] = literal(registers[reg]);
+		}
+
+		std::ostringstream out;
+		out << "// Generated by ORCHESTRA from a compiled expression program, do not edit\n";
+		out << "#include <cmath>\n\n";
+
+		bool usesFastMath = false;
+		for (const Instruction& in : instructions)
+		{
+			usesFastMath = usesFastMath || ((in.opcode >= FAST_POWER10) && (in.opcode <= FAST_EXP));
+			usesFastMath = usesFastMath || ((in.opcode == MASS_ACTION) && sparseBlocks[in.a].fastMath);
+		}
+		if (usesFastMath)
+		{
+			// the FastMath kernels are called in the executable, the loader sets these pointers
+			out << "extern \"C\"\n{\n";
+			out << "\tdouble (*orchestra_exp10)(double) = 0;\n";
+			out << "\tdouble (*orchestra_log)(double) = 0;\n";
+			out << "\tdouble (*orchestra_log10)(double) = 0;\n";
+			out << "\tdouble (*orchestra_exp)(double) = 0;\n";
+			out << "}\n\n";
+		}
+		out << "extern \"C\" void orchestra_run_invariant(double* r)\n{\n";
+
+		for (size_t n = 0; n <= instructions.size(); n++)
+		{
+			if (n == (size_t)nrInvariantInstructions)
+			{
+				// executed again when only unknowns changed
+				out << "}\n\nextern \"C\" void orchestra_run_variant(double* r)\n{\n";
+			}
+			if (n == instructions.size())
+			{
+				break;
+			}
+			const Instruction& in = instructions[n];
+
+			if ((in.opcode == MASS_ACTION) || (in.opcode == MASS_BALANCE))
+			{
+				const SparseBlock& block = sparseBlocks[in.a];
+				for (size_t k = 0; k < block.results.size(); k++)
+				{
+					out << "\t" << names[block.results[k]] << " = ";
+					if (block.exponential)
+					{
+						out << (block.fastMath ? "orchestra_exp10(" : "std::pow(10.0, ");
+					}
+					out << literal(block.constants[k]);
+					for (int t = block.rowStart[k]; t < block.rowStart[k + 1]; t++)
+					{
+						out << " + " << literal(block.coefficients[t]) << " * " << names[block.columns[t]];
+					}
+					out << (block.exponential ? ");\n" : ";\n");
+				}
+				continue;
+			}
+
+			const std::string& a = (in.a >= 0) ? names[in.a] : names[0];
+			const std::string& b = (in.b >= 0) ? names[in.b] : names[0];
+			out << "\t" << names[in.result] << " = ";
+
+			switch (in.opcode)
+			{
+			case PLUS:    out << a << " + " << b; break;
+			case MINUS:   out << a << " - " << b; break;
+			case TIMES:   out << a << " * " << b; break;
+			case DIVIDE:  out << a << " / " << b; break;
+			case UMIN:    out << "-" << a; break;
+			case ABS:     out << "std::abs(" << a << ")"; break;
+			case MAX:     out << "(" << a << " > " << b << ") ? " << a << " : " << b; break;
+			case MIN:     out << "(" << a << " < " << b << ") ? " << a << " : " << b; break;
+			case POWER:   out << "std::pow(" << a << ", " << b << ")"; break;
+			case POWER10: out << "std::pow(10.0, " << a << ")"; break;
+			case SQR:     out << a << " * " << a; break;
+			case SQRT:    out << "std::sqrt(" << a << ")"; break;
+			case LOG:     out << "std::log(" << a << ")"; break;
+			case LOG10:   out << "std::log10(" << a << ")"; break;
+			case EXP:     out << "std::exp(" << a << ")"; break;
+			case SIN:     out << "std::sin(" << a << ")"; break;
+			case COS:     out << "std::cos(" << a << ")"; break;
+			case TAN:     out << "std::tan(" << a << ")"; break;
+			case SINH:    out << "std::sinh(" << a << ")"; break;
+			case COSH:    out << "std::cosh(" << a << ")"; break;
+			case TANH:    out << "std::tanh(" << a << ")"; break;
+			case ATAN:    out << "std::atan(" << a << ")"; break;
+			case FAST_POWER10: out << "orchestra_exp10(" << a << ")"; break;
+			case FAST_LOG:     out << "orchestra_log(" << a << ")"; break;
+			case FAST_LOG10:   out << "orchestra_log10(" << a << ")"; break;
+			case FAST_EXP:     out << "orchestra_exp(" << a << ")"; break;
+			case MULTIPLUS:
+				// same order of summation as the MultiPlusNode
+				out << "0.0";
+				for (int n = in.b - 1; n >= 0; n--)
+				{
+					out << " + " << literal(factors[in.a + n]) << " * " << names[operands[in.a + n]];
+				}
+				break;
+			case MULTITIMES:
+				out << names[operands[in.a]];
+				for (int n = 1; n < in.b; n++)
+				{
+					out << " * " << names[operands[in.a + n]];
+				}
+				break;
+			case EQ:      out << "(" << a << " == " << b << ") ? 1.0 : 0.0"; break;
+			case LT:      out << "(" << a << " < " << b << ") ? 1.0 : 0.0"; break;
+			case GT:      out << "(" << a << " > " << b << ") ? 1.0 : 0.0"; break;
+			case LE:      out << "(" << a << " <= " << b << ") ? 1.0 : 0.0"; break;
+			case GE:      out << "(" << a << " >= " << b << ") ? 1.0 : 0.0"; break;
+			case NOT:     out << "(" << a << " != 0) ? 0.0 : 1.0"; break;
+			case SELECT:  out << "(" << a << " != 0) ? " << b << " : " << names[in.c]; break;
+			case MASS_ACTION:
+			case MASS_BALANCE:
+				// sparse blocks are written out above
+				break;
+			}
+			out << ";\n";
+		}
+		out << "}\n\n";
+		out << "extern \"C\" void orchestra_run(double* r)\n{\n";
+		out << "\torchestra_run_invariant(r);\n";
+		out << "\torchestra_run_variant(r);\n";
+		out << "}\n";
+		return out.str();
+	}
+
+#ifndef _WIN32
+	// the FastMath kernels are inline functions, native code calls them through these
+	static double fastExp10(double x) { return FastMath::exp10(x); }
+	static double fastLog(double x) { return FastMath::log(x); }
+	static double fastLog10(double x) { return FastMath::log10(x); }
+	static double fastExp(double x) { return FastMath::exp(x); }
+
+	static void setFunctionPointer(void* library, const char* name, double (*function)(double))
+	{
+		void* pointer = dlsym(library, name);
+		if (pointer != nullptr)
+		{
+			*(double (**)(double))pointer = function;
+		}
+	}
+
+	// ORCHESTRA_CACHE_DIR, or orchestra in the user's cache directory, created if necessary
+	static std::string nativeCacheDirectory()
+	{
+		std::string directory;
+		const char* cache = std::getenv("ORCHESTRA_CACHE_DIR");
+		const char* xdg = std::getenv("XDG_CACHE_HOME");
+		const char* home = std::getenv("HOME");
+		if ((cache != nullptr) && (*cache != 0))
+		{
+			directory = cache;
+		}
+		else if ((xdg != nullptr) && (*xdg != 0))
+		{
+			directory = std::string(xdg) + "/orchestra";
+		}
+		else if ((home != nullptr) && (*home != 0))
+		{
+			directory = std::string(home) + "/.cache/orchestra";
+		}
+		else
+		{
+			directory = "/tmp/orchestra_" + std::to_string(getuid());
+		}
+
+		for (size_t end = directory.find('/', 1); ; end = directory.find('/', end + 1))
+		{
+			std::string part = directory.substr(0, end);
+			if ((mkdir(part.c_str(), 0700) != 0) && (errno != EEXIST))
+			{
+				return "";
+			}
+			if (end == std::string::npos)
+			{
+				break;
+			}
+		}
+		return directory + "/";
+	}
+#endif
+
+	bool ExpressionProgram::loadNativeCode(const std::string& key)
+	{
+#ifdef _WIN32
+		IO::println("Native code for calculators is not supported on this platform, using the interpreter.");
+		return false;
+#else
+		// the program also depends on the variables used for IO, so the hash
+		// of the source is added to make sure the library matches this program
+		std::string source = generateSource();
+		std::string directory = nativeCacheDirectory();
+		if (directory.empty())
+		{
+			IO::println("Could not create the native code cache directory, using the interpreter.");
+			return false;
+		}
+		std::string baseName = directory + "orchestra_" + hexString(hashString(key)) + "_" + hexString(hashString(source));
+		std::string libraryName = baseName + ".so";
+
+		void* library = dlopen(libraryName.c_str(), RTLD_NOW | RTLD_LOCAL);
+
+		if (library == nullptr)
+		{
+			// multiple calculators (threads) may compile at the same time, so each one
+			// writes its own temporary files and renames the result into place
+			std::string tmpName = baseName + "_" + std::to_string(getpid()) + "_" + hexString((unsigned long long)this);
+			std::string sourceName = tmpName + ".cpp";
+			{
+				std::ofstream sourceFile(sourceName);
+				sourceFile << source;
+				if (!sourceFile)
+				{
+					IO::println("Could not write " + sourceName);
+					return false;
+				}
+			}
+
+			const char* compiler = std::getenv("ORCHESTRA_CXX");
+			std::string command = std::string((compiler != nullptr) ? compiler : "c++")
+				+ " -O2 -ffp-contract=off -shared -fPIC -o \"" + tmpName + ".so\" \"" + sourceName + "\"";
+
+			IO::println("Compiling native code: " + command);
+			int result = std::system(command.c_str());
+			std::remove(sourceName.c_str());
+
+			if ((result != 0) || (std::rename((tmpName + ".so").c_str(), (baseName + ".so").c_str()) != 0))
+			{
+				IO::println("Compilation of native code failed, using the interpreter.");
+				std::remove((tmpName + ".so").c_str());
+				return false;
+			}
+
+			library = dlopen(libraryName.c_str(), RTLD_NOW | RTLD_LOCAL);
+			if (library == nullptr)
+			{
+				IO::println(std::string("Could not load native code: ") + dlerror());
+				return false;
+			}
+		}
+
+		setFunctionPointer(library, "orchestra_exp10", &fastExp10);
+		setFunctionPointer(library, "orchestra_log", &fastLog);
+		setFunctionPointer(library, "orchestra_log10", &fastLog10);
+		setFunctionPointer(library, "orchestra_exp", &fastExp);
+
+		// clones share the library, it is closed with the last program that uses it
+		nativeLibrary = std::shared_ptr<void>(library, [](void* handle) { dlclose(handle); });
+		nativeFunction = (NativeFunction)dlsym(library, "orchestra_run");
+		nativeVariantFunction = (NativeFunction)dlsym(library, "orchestra_run_variant");
+		return (nativeFunction != nullptr);
+#endif
+	}
+
+}
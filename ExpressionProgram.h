@@ -0,0 +1,401 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <memory>
+#include "ExpressionNode.h"
+
+namespace orchestracpp { class Var; }
+
+namespace orchestracpp
+{
+
+	/**
+	 * The ExpressionProgram is a compiled form of the optimized expression graph.
+	 * Each node of the graph is translated into a single instruction that operates on
+	 * a contiguous array of registers. The instructions are stored in topological
+	 * order, so the program can be evaluated with a single loop over the instruction
+	 * array, without virtual method calls or pointer chasing through the graph.
+	 *
+	 * The input registers are loaded from the (non constant) variables at the start
+	 * of each run. If only unknowns changed since the previous run, for example
+	 * during the calculation of the jacobian, only the instructions that depend on
+	 * these unknowns are executed. The instructions are partitioned in finish: first the
+	 * input-invariant instructions, that do not depend on any unknown and are executed once
+	 * per node, then the iteration-variant instructions, that are executed again when the
+	 * Newton iteration changes the unknowns. Within the input-invariant part the instructions
+	 * that depend only on inputs that are shared by a batch of nodes (setSharedInputs) come first,
+	 * these are skipped as long as the values of the shared inputs do not change.
+	 * The parameters (@parameter:) are not folded into constants but are loaded only once, the
+	 * instructions that depend only on parameters come first and are executed again by
+	 * setParameter, for the parameter that was changed only.
+	 *
+	 * The Newton iteration uses evaluation plans (selectPlan): the iteration-variant instructions
+	 * that the equations of the active uneqs depend on, with the if nodes resolved to the branch
+	 * that was taken when the plan was made. The subgraphs of inactive mineral uneqs and of the
+	 * branches that are not taken are then not evaluated during the iteration.
+	 *
+	 * Both branches of an if node are evaluated and the result is selected afterwards,
+	 * this gives the same values as the expression graph, as the nodes have no side effects.
+	 *
+	 * Most species concentrations are calculated as 10^(logK + sum of stoichiometric
+	 * coefficient * log activity + activity correction). These exponentials and the linear
+	 * combinations in their exponents are fused into mass action kernels: one sparse
+	 * stoichiometry matrix vector product (CSR) followed by an exp10 over the whole vector.
+	 * The terms are summed in the order of the original expressions, so the results are
+	 * the same as those of the separate instructions.
+	 *
+	 * The equations for total concentrations are sums of coefficient * species concentration.
+	 * These linear combinations (the MultiPlusNodes and chains of plus and minus nodes of the
+	 * roots) are fused into mass balance kernels, a CSR matrix vector product over the results
+	 * of the mass action kernels. The same matrices give the analytic jacobian of these equations:
+	 * the gradient of a mass balance is the matrix times the gradients of its columns, the gradient
+	 * of a species is ln(10) * its concentration * its stoichiometry row times the gradients of the
+	 * log activities.
+	 *
+	 * The program can also be translated into a C++ source file with straight-line code,
+	 * that is compiled with the system compiler into a shared library and loaded at run time.
+	 *
+	 * In batch mode each register holds W values (lanes), one for each node of a batch of
+	 * nodes of the same node type. One pass over the instructions then evaluates the program
+	 * for W nodes, the lanes of a register are contiguous so the compiler can vectorize the
+	 * loops over the lanes. If, max and min become lane-wise selects.
+	 */
+	class ExpressionProgram final
+	{
+
+	public:
+		enum Opcode
+		{
+			PLUS, MINUS, TIMES, DIVIDE, UMIN, ABS, MAX, MIN, POWER, POWER10,
+			SQR, SQRT, LOG, LOG10, EXP, SIN, COS, TAN, SINH, COSH, TANH, ATAN,
+			FAST_POWER10, FAST_LOG, FAST_LOG10, FAST_EXP, // FastMath kernels (@fastmath:)
+			MULTIPLUS, // a = first operand index, b = number of operands
+			MULTITIMES,
+			EQ, LT, GT, LE, GE, NOT, // results are 1 (true) or 0 (false)
+			SELECT,    // a = condition, b = value if true, c = value if false
+			MASS_ACTION, // a = sparse block, calculates all its results
+			MASS_BALANCE // a = sparse block
+		};
+
+		struct Instruction
+		{
+			Opcode opcode;
+			int result;
+			int a;
+			int b;
+			int c;
+		};
+
+		std::vector<double> registers;
+
+		bool massActionKernels = true; // fuse the exponentials and mass balances into sparse kernels in finish
+		int nrPrintNodes = 0;          // print() nodes met while compiling, these have no instruction
+
+		ExpressionProgram();
+
+		/**
+		 * Adds the expression of this variable to the program and
+		 * returns the register that will contain its value.
+		 */
+		int addRoot(Var* var);
+
+		/**
+		 * Called after all roots are added, determines for each unknown input
+		 * which instructions have to be executed when its value changes.
+		 */
+		void finish();
+
+		/**
+		 * Returns the register of this node, compiles the node first if necessary.
+		 * Nodes that are shared by multiple parents are compiled only once.
+		 */
+		int compile(ExpressionNode* node);
+		int compile(BExpressionNode* node);
+
+		int addConstant(double value);
+		int addInput(Var* var);
+		int addInstruction(Opcode opcode, int a, int b = -1, int c = -1);
+		int addMultiPlus(int nrOperands, ExpressionNode** operands, double* factors);
+		int addMultiTimes(int nrOperands, ExpressionNode** operands);
+
+		/**
+		 * Load the input variables and execute the instructions that depend on changed inputs.
+		 */
+		void run();
+
+		/**
+		 * Run, and keep the register values as the central point of a finite difference jacobian.
+		 */
+		void saveCentral();
+
+		/**
+		 * After the jacobian column of an (unknown) input, restore the central values of the input
+		 * and of the registers that depend on it, instead of calculating these again in the next run.
+		 * The value of the input variable must have been reset to its central value.
+		 */
+		void restoreCentral(int input);
+
+		inline double getValue(int reg) { return registers[reg]; }
+
+		int getNrInstructions() { return (int)instructions.size(); }
+		int getNrInvariantInstructions() { return nrInvariantInstructions; }
+		int getNrVariantInstructions() { return (int)instructions.size() - nrInvariantInstructions; }
+		int getNrSharedInstructions() { return nrSharedInstructions; }
+		int getNrParameterInstructions() { return nrParameterInstructions; }
+		int getNrParameters() { return (int)parameterVars.size(); }
+
+		/**
+		 * Changes the value of a parameter and executes the instructions that depend only on the
+		 * parameters and on this one in particular, so the results of the folded subgraphs of this
+		 * parameter are up to date. The next run executes all other instructions.
+		 * Does nothing if the program does not use this parameter.
+		 */
+		void setParameter(Var* var, double value);
+
+		/**
+		 * Marks the inputs that have the same value for all nodes of a batch, e.g. the temperature
+		 * or the static node variables. The input-invariant instructions that depend only on these
+		 * inputs (and constants) are moved to the front of the program. A full run skips them when
+		 * the values of the shared inputs did not change, so their registers act as a cache keyed
+		 * on these values and they are evaluated once for the whole batch.
+		 */
+		void setSharedInputs(const std::vector<bool>& shared);
+
+		/**
+		 * Selects the evaluation plan for these equations (the registers of the active uneqs),
+		 * and makes it when it does not exist yet. Plans are cached on the equations and on
+		 * the values of the conditions of their if nodes. The conditions are checked when the
+		 * plan is executed, if one of them flips the run falls back to all instructions and the
+		 * plan is dropped until the next selectPlan. Plans are not used with native code or in
+		 * batch mode, and only the registers of these equations (and of what they depend on)
+		 * are up to date after a run with a plan.
+		 */
+		void selectPlan(const std::vector<int>& equations);
+
+		bool usePlans = true; // switched off with @noplans:
+
+		int getNrPlans() { return (int)plans.size(); }
+
+		int getNrMassActionBlocks() { return getNrBlocks(true); }
+		int getNrMassActionRows() { return getNrRows(true); }
+		int getNrMassBalanceBlocks() { return getNrBlocks(false); }
+		int getNrMassBalanceRows() { return getNrRows(false); }
+
+		/**
+		 * Prepares the analytic jacobian of the equations (registers) to the unknowns (inputs).
+		 * The derivatives to a logarithmic unknown are taken to its log10, as the Newton steps
+		 * of these unknowns are taken in log10. Returns false if one of the equations depends on
+		 * the unknowns through an instruction that is not differentiated here (e.g. if, max or the
+		 * product of two unknowns), the jacobian then has to be calculated with finite differences.
+		 */
+		bool prepareJacobian(const std::vector<int>& equations, const std::vector<int>& unknowns, const std::vector<bool>& logarithmic);
+
+		/**
+		 * The prepared jacobian at the values of the last run, the derivative of equation f
+		 * to unknown i is stored in jacobian[f * number of unknowns + i].
+		 */
+		void calculateJacobian(double* jacobian);
+
+		/**
+		 * Returns the C++ source of a function that executes all instructions of this program,
+		 * and of a function that executes only the iteration-variant instructions.
+		 */
+		std::string generateSource();
+
+		/**
+		 * Compile the generated source into a shared library and use it instead of the
+		 * interpreter. The library is cached under a hash of the key (the expanded input text)
+		 * and of the generated source, in the directory set with the ORCHESTRA_CACHE_DIR
+		 * environment variable, or else in $XDG_CACHE_HOME/orchestra or ~/.cache/orchestra.
+		 * The compiler can be set with the ORCHESTRA_CXX environment variable.
+		 * Returns false if native code could not be created or loaded.
+		 */
+		bool loadNativeCode(const std::string& key);
+
+		bool usesNativeCode() { return nativeFunction != nullptr; }
+
+		/**
+		 * Allocates the batch registers for a batch of width (4 or 8) nodes
+		 * and fills all lanes of the constant registers.
+		 */
+		void initBatch(int width);
+
+		int getBatchWidth() { return batchWidth; }
+
+		int getNrInputs() { return (int)inputVars.size(); }
+		Var* getInputVar(int input) { return inputVars[input]; }
+
+		/**
+		 * Copies the current values of the input variables into this lane.
+		 */
+		void loadBatchInputs(int lane);
+
+		/**
+		 * The lanes of an input register, these can also be set directly.
+		 */
+		inline double* getBatchInput(int input) { return &batchRegisters[(size_t)inputRegisters[input] * batchWidth]; }
+
+		/**
+		 * Executes all instructions for all lanes, except the shared instructions if the shared
+		 * inputs were not changed by loadBatchInputs. The native code is not used in batch mode.
+		 */
+		void runBatch();
+
+		/**
+		 * Executes only the instructions that depend on this (unknown) input,
+		 * e.g. after it was offset in all lanes for a column of the jacobian.
+		 */
+		void runBatch(int changedInput);
+
+		/**
+		 * Executes only the iteration-variant instructions, after the unknowns were changed
+		 * in all lanes. The other inputs have to be the same as in the previous runBatch().
+		 */
+		void runBatchVariant();
+
+		inline const double* getBatchValue(int reg) { return &batchRegisters[(size_t)reg * batchWidth]; }
+
+	private:
+		std::vector<Instruction> instructions;
+		std::vector<int> operands;     // operand registers of the multiplus and multitimes instructions
+		std::vector<double> factors;   // and their factors
+
+		std::vector<int> constantRegisters;
+		int nrInvariantInstructions = 0; // the instructions that do not depend on the unknowns come first
+		int nrSharedInstructions = 0;    // and of these first the ones that depend only on shared inputs
+		std::vector<bool> sharedInputs;
+		bool sharedChanged = true;       // a shared input changed since the shared instructions were executed
+		bool batchSharedChanged = true;
+		int nrParameterInstructions = 0; // the instructions that depend only on parameters come before all others
+		bool parametersChanged = false;  // a parameter changed since the last full run
+		bool batchParametersChanged = true;
+		std::vector<int> rootRegisters;
+
+		/**
+		 * The rows of a mass balance kernel: results[k] = constants[k] + sum over the terms t
+		 * of row k of coefficients[t] * register columns[t], the terms of row k are
+		 * rowStart[k] .. rowStart[k + 1] - 1. The rows of a mass action kernel (exponential)
+		 * are 10 to the power of this sum.
+		 */
+		struct SparseBlock
+		{
+			bool exponential = false;
+			bool fastMath = false;
+			std::vector<int> results;
+			std::vector<double> constants;
+			std::vector<int> rowStart;
+			std::vector<int> columns;
+			std::vector<double> coefficients;
+			std::vector<double> exponents; // work space
+		};
+		std::vector<SparseBlock> sparseBlocks;
+
+		// a linear combination (the exponent of an exponential, or a mass balance), while fusing
+		struct SparseRow
+		{
+			int instruction = -1;
+			double constant = 0;
+			std::vector<int> columns;
+			std::vector<double> coefficients;
+			std::vector<int> absorbed; // the instructions of the linear combination
+			int lastLeaf = -1;         // the last instruction that calculates one of the columns
+			std::vector<bool> dependencies; // only rows with the same dependencies are fused
+		};
+
+		/**
+		 * The gradient of a register to the unknowns is stored in a slot of the gradients array.
+		 * A step calculates slot = scale * (unit vector of unknown, or the sum over its terms of
+		 * coefficient * the gradient in slot term).
+		 */
+		enum GradientScale { SCALE_NONE, SCALE_VALUE, SCALE_INVERSE, SCALE_LN10_VALUE, SCALE_INVERSE_LN10_VALUE };
+		struct GradientStep
+		{
+			int slot;
+			int unknown;   // -1 for a sum of terms
+			int firstTerm;
+			int nrTerms;
+			GradientScale scale;
+			int scaleRegister;
+		};
+		std::vector<GradientStep> gradientSteps;
+		std::vector<int> gradientTerms;
+		std::vector<double> gradientCoefficients;
+		std::vector<int> equationSlots;  // -1 if the equation does not depend on the unknowns
+		std::vector<double> gradients;
+		int jacobianSize = 0;
+
+		struct GradientContext
+		{
+			std::vector<int> definition;
+			std::vector<bool> depends;
+			std::vector<int> unknownOf;
+			std::vector<bool> logarithmic;
+			std::vector<int> slots;  // -2: not visited yet, -1: zero gradient
+			bool analytic = true;
+		};
+
+		struct Plan
+		{
+			std::vector<int> equations;                // sorted registers
+			std::vector<std::pair<int, bool>> guards;  // the select instructions in the plan and their conditions
+			std::vector<signed char> guardOf;          // per instruction: -1, or the expected condition
+			std::vector<std::vector<int>> inputDependents;
+		};
+		static const int maxNrPlans = 32;
+		std::vector<Plan> plans;
+		int currentPlan = -1;
+		bool planRan = false;        // the instructions that are not in the plan may be out of date
+		bool refreshVariant = false; // execute all iteration-variant instructions in the next run
+
+		typedef void (*NativeFunction)(double* registers);
+		NativeFunction nativeFunction = nullptr;
+		NativeFunction nativeVariantFunction = nullptr;
+		std::shared_ptr<void> nativeLibrary; // dlopen handle, shared with the clones of this program
+
+		std::vector<Var*> inputVars;
+		std::vector<int> inputRegisters;
+		std::vector<std::vector<int>> inputDependents; // instructions that depend on each (unknown) input
+		std::vector<std::vector<int>> inputResults;    // the registers calculated by these instructions
+		std::vector<bool> inputHasDependents;
+		std::vector<double> centralRegisters;
+
+		std::vector<Var*> parameterVars;  // the parameters are not loaded in each run
+		std::vector<int> parameterRegisters;
+		std::vector<std::vector<int>> parameterDependents; // parameter instructions that depend on each parameter
+
+		std::unordered_map<void*, int> nodeRegisters;
+		std::vector<int> changedInputs;
+		std::vector<char> marked;      // instructions to execute when more than one unknown changed
+		bool firstRun = true;
+
+		int batchWidth = 0;
+		std::vector<double> batchRegisters; // register major, the lanes of a register are contiguous
+
+		void execute(const Instruction& instruction);
+		void executeSparseBlock(SparseBlock& block);
+		void getDefinitions(std::vector<int>& definition);
+		void getInputDependent(std::vector<bool>& inputDependent);
+		void getInputDependencies(std::vector<std::vector<bool>>& dependencies);
+		void fuseMassActions();
+		void fuseMassBalances();
+		void fuseRows(const std::vector<SparseRow>& rows, bool exponential);
+		void linearize(int reg, const std::vector<int>& definition, SparseRow& row);
+		void addTerm(int reg, double sign, const std::vector<int>& definition, SparseRow& row);
+		int getNrBlocks(bool exponential);
+		int getNrRows(bool exponential);
+		int addGradient(int reg, GradientContext& context);
+		int addGradientStep(int unknown, const std::vector<int>& terms, const std::vector<double>& coefficients, GradientScale scale, int scaleRegister);
+		void getResults(const Instruction& instruction, std::vector<int>& result);
+		template <int W> void executeBatch(const Instruction& instruction);
+		template <int W> void runBatch(const std::vector<int>* selection, int first = 0);
+		void partitionInstructions();
+		void buildPlan(const std::vector<int>& equations);
+		void runPlan();
+		bool executeGuarded(const Plan& plan, int n);
+		void executeVariant();
+		void getOperands(const Instruction& instruction, std::vector<int>& result);
+	};
+
+}
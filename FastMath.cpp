@@ -0,0 +1,258 @@
+#include "FastMath.h"
+
+namespace orchestracpp
+{
+
+	// The tables are computed with 60 digit decimal arithmetic and rounded to the nearest double.
+
+	const double FastMath::exp2Table[128] =
+	{
+		0x1.0000000000000p+0, 0x1.0163da9fb3335p+0, 0x1.02c9a3e778061p+0, 0x1.04315e86e7f85p+0,
+		0x1.059b0d3158574p+0, 0x1.0706b29ddf6dep+0, 0x1.0874518759bc8p+0, 0x1.09e3ecac6f383p+0,
+		0x1.0b5586cf9890fp+0, 0x1.0cc922b7247f7p+0, 0x1.0e3ec32d3d1a2p+0, 0x1.0fb66affed31bp+0,
+		0x1.11301d0125b51p+0, 0x1.12abdc06c31ccp+0, 0x1.1429aaea92de0p+0, 0x1.15a98c8a58e51p+0,
+		0x1.172b83c7d517bp+0, 0x1.18af9388c8deap+0, 0x1.1a35beb6fcb75p+0, 0x1.1bbe084045cd4p+0,
+		0x1.1d4873168b9aap+0, 0x1.1ed5022fcd91dp+0, 0x1.2063b88628cd6p+0, 0x1.21f49917ddc96p+0,
+		0x1.2387a6e756238p+0, 0x1.251ce4fb2a63fp+0, 0x1.26b4565e27cddp+0, 0x1.284dfe1f56381p+0,
+		0x1.29e9df51fdee1p+0, 0x1.2b87fd0dad990p+0, 0x1.2d285a6e4030bp+0, 0x1.2ecafa93e2f56p+0,
+		0x1.306fe0a31b715p+0, 0x1.32170fc4cd831p+0, 0x1.33c08b26416ffp+0, 0x1.356c55f929ff1p+0,
+		0x1.371a7373aa9cbp+0, 0x1.38cae6d05d866p+0, 0x1.3a7db34e59ff7p+0, 0x1.3c32dc313a8e5p+0,
+		0x1.3dea64c123422p+0, 0x1.3fa4504ac801cp+0, 0x1.4160a21f72e2ap+0, 0x1.431f5d950a897p+0,
+		0x1.44e086061892dp+0, 0x1.46a41ed1d0057p+0, 0x1.486a2b5c13cd0p+0, 0x1.4a32af0d7d3dep+0,
+		0x1.4bfdad5362a27p+0, 0x1.4dcb299fddd0dp+0, 0x1.4f9b2769d2ca7p+0, 0x1.516daa2cf6642p+0,
+		0x1.5342b569d4f82p+0, 0x1.551a4ca5d920fp+0, 0x1.56f4736b527dap+0, 0x1.58d12d497c7fdp+0,
+		0x1.5ab07dd485429p+0, 0x1.5c9268a5946b7p+0, 0x1.5e76f15ad2148p+0, 0x1.605e1b976dc09p+0,
+		0x1.6247eb03a5585p+0, 0x1.6434634ccc320p+0, 0x1.6623882552225p+0, 0x1.68155d44ca973p+0,
+		0x1.6a09e667f3bcdp+0, 0x1.6c012750bdabfp+0, 0x1.6dfb23c651a2fp+0, 0x1.6ff7df9519484p+0,
+		0x1.71f75e8ec5f74p+0, 0x1.73f9a48a58174p+0, 0x1.75feb564267c9p+0, 0x1.780694fde5d3fp+0,
+		0x1.7a11473eb0187p+0, 0x1.7c1ed0130c132p+0, 0x1.7e2f336cf4e62p+0, 0x1.80427543e1a12p+0,
+		0x1.82589994cce13p+0, 0x1.8471a4623c7adp+0, 0x1.868d99b4492edp+0, 0x1.88ac7d98a6699p+0,
+		0x1.8ace5422aa0dbp+0, 0x1.8cf3216b5448cp+0, 0x1.8f1ae99157736p+0, 0x1.9145b0b91ffc6p+0,
+		0x1.93737b0cdc5e5p+0, 0x1.95a44cbc8520fp+0, 0x1.97d829fde4e50p+0, 0x1.9a0f170ca07bap+0,
+		0x1.9c49182a3f090p+0, 0x1.9e86319e32323p+0, 0x1.a0c667b5de565p+0, 0x1.a309bec4a2d33p+0,
+		0x1.a5503b23e255dp+0, 0x1.a799e1330b358p+0, 0x1.a9e6b5579fdbfp+0, 0x1.ac36bbfd3f37ap+0,
+		0x1.ae89f995ad3adp+0, 0x1.b0e07298db666p+0, 0x1.b33a2b84f15fbp+0, 0x1.b59728de5593ap+0,
+		0x1.b7f76f2fb5e47p+0, 0x1.ba5b030a1064ap+0, 0x1.bcc1e904bc1d2p+0, 0x1.bf2c25bd71e09p+0,
+		0x1.c199bdd85529cp+0, 0x1.c40ab5fffd07ap+0, 0x1.c67f12e57d14bp+0, 0x1.c8f6d9406e7b5p+0,
+		0x1.cb720dcef9069p+0, 0x1.cdf0b555dc3fap+0, 0x1.d072d4a07897cp+0, 0x1.d2f87080d89f2p+0,
+		0x1.d5818dcfba487p+0, 0x1.d80e316c98398p+0, 0x1.da9e603db3285p+0, 0x1.dd321f301b460p+0,
+		0x1.dfc97337b9b5fp+0, 0x1.e264614f5a129p+0, 0x1.e502ee78b3ff6p+0, 0x1.e7a51fbc74c83p+0,
+		0x1.ea4afa2a490dap+0, 0x1.ecf482d8e67f1p+0, 0x1.efa1bee615a27p+0, 0x1.f252b376bba97p+0,
+		0x1.f50765b6e4540p+0, 0x1.f7bfdad9cbe14p+0, 0x1.fa7c1819e90d8p+0, 0x1.fd3c22b8f71f1p+0
+	};
+
+	const FastMath::LogTable FastMath::logTable =
+	{
+		// c
+		{
+			0x1.6100000000000p-1, 0x1.6300000000000p-1, 0x1.6500000000000p-1, 0x1.6700000000000p-1,
+			0x1.6900000000000p-1, 0x1.6b00000000000p-1, 0x1.6d00000000000p-1, 0x1.6f00000000000p-1,
+			0x1.7100000000000p-1, 0x1.7300000000000p-1, 0x1.7500000000000p-1, 0x1.7700000000000p-1,
+			0x1.7900000000000p-1, 0x1.7b00000000000p-1, 0x1.7d00000000000p-1, 0x1.7f00000000000p-1,
+			0x1.8100000000000p-1, 0x1.8300000000000p-1, 0x1.8500000000000p-1, 0x1.8700000000000p-1,
+			0x1.8900000000000p-1, 0x1.8b00000000000p-1, 0x1.8d00000000000p-1, 0x1.8f00000000000p-1,
+			0x1.9100000000000p-1, 0x1.9300000000000p-1, 0x1.9500000000000p-1, 0x1.9700000000000p-1,
+			0x1.9900000000000p-1, 0x1.9b00000000000p-1, 0x1.9d00000000000p-1, 0x1.9f00000000000p-1,
+			0x1.a100000000000p-1, 0x1.a300000000000p-1, 0x1.a500000000000p-1, 0x1.a700000000000p-1,
+			0x1.a900000000000p-1, 0x1.ab00000000000p-1, 0x1.ad00000000000p-1, 0x1.af00000000000p-1,
+			0x1.b100000000000p-1, 0x1.b300000000000p-1, 0x1.b500000000000p-1, 0x1.b700000000000p-1,
+			0x1.b900000000000p-1, 0x1.bb00000000000p-1, 0x1.bd00000000000p-1, 0x1.bf00000000000p-1,
+			0x1.c100000000000p-1, 0x1.c300000000000p-1, 0x1.c500000000000p-1, 0x1.c700000000000p-1,
+			0x1.c900000000000p-1, 0x1.cb00000000000p-1, 0x1.cd00000000000p-1, 0x1.cf00000000000p-1,
+			0x1.d100000000000p-1, 0x1.d300000000000p-1, 0x1.d500000000000p-1, 0x1.d700000000000p-1,
+			0x1.d900000000000p-1, 0x1.db00000000000p-1, 0x1.dd00000000000p-1, 0x1.df00000000000p-1,
+			0x1.e100000000000p-1, 0x1.e300000000000p-1, 0x1.e500000000000p-1, 0x1.e700000000000p-1,
+			0x1.e900000000000p-1, 0x1.eb00000000000p-1, 0x1.ed00000000000p-1, 0x1.ef00000000000p-1,
+			0x1.f100000000000p-1, 0x1.f300000000000p-1, 0x1.f500000000000p-1, 0x1.f700000000000p-1,
+			0x1.f900000000000p-1, 0x1.fb00000000000p-1, 0x1.fd00000000000p-1, 0x1.0000000000000p+0,
+			0x1.0000000000000p+0, 0x1.0300000000000p+0, 0x1.0500000000000p+0, 0x1.0700000000000p+0,
+			0x1.0900000000000p+0, 0x1.0b00000000000p+0, 0x1.0d00000000000p+0, 0x1.0f00000000000p+0,
+			0x1.1100000000000p+0, 0x1.1300000000000p+0, 0x1.1500000000000p+0, 0x1.1700000000000p+0,
+			0x1.1900000000000p+0, 0x1.1b00000000000p+0, 0x1.1d00000000000p+0, 0x1.1f00000000000p+0,
+			0x1.2100000000000p+0, 0x1.2300000000000p+0, 0x1.2500000000000p+0, 0x1.2700000000000p+0,
+			0x1.2900000000000p+0, 0x1.2b00000000000p+0, 0x1.2d00000000000p+0, 0x1.2f00000000000p+0,
+			0x1.3100000000000p+0, 0x1.3300000000000p+0, 0x1.3500000000000p+0, 0x1.3700000000000p+0,
+			0x1.3900000000000p+0, 0x1.3b00000000000p+0, 0x1.3d00000000000p+0, 0x1.3f00000000000p+0,
+			0x1.4100000000000p+0, 0x1.4300000000000p+0, 0x1.4500000000000p+0, 0x1.4700000000000p+0,
+			0x1.4900000000000p+0, 0x1.4b00000000000p+0, 0x1.4d00000000000p+0, 0x1.4f00000000000p+0,
+			0x1.5100000000000p+0, 0x1.5300000000000p+0, 0x1.5500000000000p+0, 0x1.5700000000000p+0,
+			0x1.5900000000000p+0, 0x1.5b00000000000p+0, 0x1.5d00000000000p+0, 0x1.5f00000000000p+0
+		},
+		// invC
+		{
+			0x1.734f0c541fe8dp+0, 0x1.713786d9c7c09p+0, 0x1.6f26016f26017p+0, 0x1.6d1a62681c861p+0,
+			0x1.6b1490aa31a3dp+0, 0x1.691473a88d0c0p+0, 0x1.6719f3601671ap+0, 0x1.6524f853b4aa3p+0,
+			0x1.63356b88ac0dep+0, 0x1.614b36831ae94p+0, 0x1.5f66434292dfcp+0, 0x1.5d867c3ece2a5p+0,
+			0x1.5babcc647fa91p+0, 0x1.59d61f123ccaap+0, 0x1.5805601580560p+0, 0x1.56397ba7c52e2p+0,
+			0x1.54725e6bb82fep+0, 0x1.52aff56a8054bp+0, 0x1.50f22e111c4c5p+0, 0x1.4f38f62dd4c9bp+0,
+			0x1.4d843bedc2c4cp+0, 0x1.4bd3edda68fe1p+0, 0x1.4a27fad76014ap+0, 0x1.4880522014880p+0,
+			0x1.46dce34596066p+0, 0x1.453d9e2c776cap+0, 0x1.43a2730abee4dp+0, 0x1.420b5265e5951p+0,
+			0x1.40782d10e6566p+0, 0x1.3ee8f42a5af07p+0, 0x1.3d5d991aa75c6p+0, 0x1.3bd60d9232955p+0,
+			0x1.3a524387ac822p+0, 0x1.38d22d366088ep+0, 0x1.3755bd1c945eep+0, 0x1.35dce5f9f2af8p+0,
+			0x1.34679ace01346p+0, 0x1.32f5ced6a1dfap+0, 0x1.3187758e9ebb6p+0, 0x1.301c82ac40260p+0,
+			0x1.2eb4ea1fed14bp+0, 0x1.2d50a012d50a0p+0, 0x1.2bef98e5a3711p+0, 0x1.2a91c92f3c105p+0,
+			0x1.293725bb804a5p+0, 0x1.27dfa38a1ce4dp+0, 0x1.268b37cd60127p+0, 0x1.2539d7e9177b2p+0,
+			0x1.23eb79717605bp+0, 0x1.22a0122a0122ap+0, 0x1.21579804855e6p+0, 0x1.2012012012012p+0,
+			0x1.1ecf43c7fb84cp+0, 0x1.1d8f5672e4abdp+0, 0x1.1c522fc1ce059p+0, 0x1.1b17c67f2bae3p+0,
+			0x1.19e0119e0119ep+0, 0x1.18ab083902bdbp+0, 0x1.1778a191bd684p+0, 0x1.1648d50fc3201p+0,
+			0x1.151b9a3fdd5c9p+0, 0x1.13f0e8d344724p+0, 0x1.12c8b89edc0acp+0, 0x1.11a3019a74826p+0,
+			0x1.107fbbe011080p+0, 0x1.0f5edfab325a2p+0, 0x1.0e40655826011p+0, 0x1.0d24456359e3ap+0,
+			0x1.0c0a7868b4171p+0, 0x1.0af2f722eecb5p+0, 0x1.09ddba6af8360p+0, 0x1.08cabb37565e2p+0,
+			0x1.07b9f29b8eae2p+0, 0x1.06ab59c7912fbp+0, 0x1.059eea0727586p+0, 0x1.04949cc1664c5p+0,
+			0x1.038c6b78247fcp+0, 0x1.02864fc7729e9p+0, 0x1.0182436517a37p+0, 0x1.0000000000000p+0,
+			0x1.0000000000000p+0, 0x1.fa11caa01fa12p-1, 0x1.f6310aca0dbb5p-1, 0x1.f25f644230ab5p-1,
+			0x1.ee9c7f8458e02p-1, 0x1.eae807aba01ebp-1, 0x1.e741aa59750e4p-1, 0x1.e3a9179dc1a73p-1,
+			0x1.e01e01e01e01ep-1, 0x1.dca01dca01dcap-1, 0x1.d92f2231e7f8ap-1, 0x1.d5cac807572b2p-1,
+			0x1.d272ca3fc5b1ap-1, 0x1.cf26e5c44bfc6p-1, 0x1.cbe6d9601cbe7p-1, 0x1.c8b265afb8a42p-1,
+			0x1.c5894d10d4986p-1, 0x1.c26b5392ea01cp-1, 0x1.bf583ee868d8bp-1, 0x1.bc4fd65883e7bp-1,
+			0x1.b951e2b18ff23p-1, 0x1.b65e2e3beee05p-1, 0x1.b37484ad806cep-1, 0x1.b094b31d922a4p-1,
+			0x1.adbe87f94905ep-1, 0x1.aaf1d2f87ebfdp-1, 0x1.a82e65130e159p-1, 0x1.a574107688a4ap-1,
+			0x1.a2c2a87c51ca0p-1, 0x1.a01a01a01a01ap-1, 0x1.9d79f176b682dp-1, 0x1.9ae24ea5510dap-1,
+			0x1.9852f0d8ec0ffp-1, 0x1.95cbb0be377aep-1, 0x1.934c67f9b2ce6p-1, 0x1.90d4f120190d5p-1,
+			0x1.8e6527af1373fp-1, 0x1.8bfce8062ff3ap-1, 0x1.899c0f601899cp-1, 0x1.87427bcc092b9p-1,
+			0x1.84f00c2780614p-1, 0x1.82a4a0182a4a0p-1, 0x1.8060180601806p-1, 0x1.7e225515a4f1dp-1,
+			0x1.7beb3922e017cp-1, 0x1.79baa6bb6398bp-1, 0x1.77908119ac60dp-1, 0x1.756cac201756dp-1
+		},
+		// logC
+		{
+			-0x1.7cc7f7db46a0ep-2, -0x1.76feecb947175p-2, -0x1.713e33a46a17cp-2, -0x1.6b85b4cffa3fdp-2,
+			-0x1.65d558d4ce00bp-2, -0x1.602d08af091ecp-2, -0x1.5a8cadbbedfa1p-2, -0x1.54f431b7be1a9p-2,
+			-0x1.4f637ebba9810p-2, -0x1.49da7f3bcc41fp-2, -0x1.44591e0539f49p-2, -0x1.3edf463c1683ep-2,
+			-0x1.396ce359bbf54p-2, -0x1.3401e12aecba1p-2, -0x1.2e9e2bce12286p-2, -0x1.2941afb186b7cp-2,
+			-0x1.23ec5991eba49p-2, -0x1.1e9e1678899f4p-2, -0x1.1956d3b9bc2fap-2, -0x1.14167ef367783p-2,
+			-0x1.0edd060b78081p-2, -0x1.09aa572e6c6d4p-2, -0x1.047e60cde83b8p-2, -0x1.feb2233ea07cdp-3,
+			-0x1.f474b134df229p-3, -0x1.ea4449f04aaf5p-3, -0x1.e020cc6235ab5p-3, -0x1.d60a17f903515p-3,
+			-0x1.cc000c9db3c52p-3, -0x1.c2028ab17f9b4p-3, -0x1.b811730b823d2p-3, -0x1.ae2ca6f672bd4p-3,
+			-0x1.a454082e6ab05p-3, -0x1.9a8778debaa38p-3, -0x1.90c6db9fcbcd9p-3, -0x1.871213750e994p-3,
+			-0x1.7d6903caf5ad0p-3, -0x1.73cb9074fd14dp-3, -0x1.6a399dabbd383p-3, -0x1.60b3100b09476p-3,
+			-0x1.5737cc9018cddp-3, -0x1.4dc7b897bc1c8p-3, -0x1.4462b9dc9b3dcp-3, -0x1.3b08b6757f2a9p-3,
+			-0x1.31b994d3a4f85p-3, -0x1.28753bc11aba5p-3, -0x1.1f3b925f25d41p-3, -0x1.160c8024b27b1p-3,
+			-0x1.0ce7ecdccc28dp-3, -0x1.03cdc0a51ec0dp-3, -0x1.f57bc7d9005dbp-4, -0x1.e3707ee30487bp-4,
+			-0x1.d179788219364p-4, -0x1.bf968769fca11p-4, -0x1.adc77ee5aea8cp-4, -0x1.9c0c32d4d2548p-4,
+			-0x1.8a6477a91dc29p-4, -0x1.78d02263d82d3p-4, -0x1.674f089365a7ap-4, -0x1.55e10050e0384p-4,
+			-0x1.4485e03dbdfadp-4, -0x1.333d7f8183f4bp-4, -0x1.2207b5c78549ep-4, -0x1.10e45b3cae831p-4,
+			-0x1.ffa6911ab9301p-5, -0x1.dda8adc67ee4ep-5, -0x1.bbcebfc68f420p-5, -0x1.9a187b573de7cp-5,
+			-0x1.788595a3577bap-5, -0x1.5715c4c03ceefp-5, -0x1.35c8bfaa1306bp-5, -0x1.149e3e4005a8dp-5,
+			-0x1.e72bf2813ce51p-6, -0x1.a55f548c5c43fp-6, -0x1.63d6178690bd6p-6, -0x1.228fb1fea2e28p-6,
+			-0x1.c317384c75f06p-7, -0x1.41929f96832f0p-7, -0x1.8121214586b54p-8, 0x0p+0,
+			0x0p+0, 0x1.7dc475f810a77p-7, 0x1.3cea44346a575p-6, 0x1.b9fc027af9198p-6,
+			0x1.1b0d98923d980p-5, 0x1.58a5bafc8e4d5p-5, 0x1.95c830ec8e3ebp-5, 0x1.d276b8adb0b52p-5,
+			0x1.075983598e471p-4, 0x1.253f62f0a1417p-4, 0x1.42edcbea646f0p-4, 0x1.60658a93750c4p-4,
+			0x1.7da766d7b12cdp-4, 0x1.9ab42462033adp-4, 0x1.b78c82bb0eda1p-4, 0x1.d4313d66cb35dp-4,
+			0x1.f0a30c01162a6p-4, 0x1.0671512ca596ep-3, 0x1.14785846742acp-3, 0x1.2266f190a5acbp-3,
+			0x1.303d718e47fd3p-3, 0x1.3dfc2b0ecc62ap-3, 0x1.4ba36f39a55e5p-3, 0x1.59338d9982086p-3,
+			0x1.66acd4272ad51p-3, 0x1.740f8f54037a5p-3, 0x1.815c0a14357ebp-3, 0x1.8e928de886d41p-3,
+			0x1.9bb362e7dfb83p-3, 0x1.a8becfc882f19p-3, 0x1.b5b519e8fb5a4p-3, 0x1.c2968558c18c1p-3,
+			0x1.cf6354e09c5dcp-3, 0x1.dc1bca0abec7dp-3, 0x1.e8c0252aa5a60p-3, 0x1.f550a564b7b37p-3,
+			0x1.00e6c45ad501dp-2, 0x1.071b85fcd590dp-2, 0x1.0d46b579ab74bp-2, 0x1.136870293a8b0p-2,
+			0x1.1980d2dd4236fp-2, 0x1.1f8ff9e48a2f3p-2, 0x1.2596010df763ap-2, 0x1.2b9303ab89d25p-2,
+			0x1.31871c9544185p-2, 0x1.3772662bfd85bp-2, 0x1.3d54fa5c1f710p-2, 0x1.432ef2a04e814p-2
+		},
+		// logCLow
+		{
+			0x1.8438023cdc3d3p-56, 0x1.118d9eb4ea362p-56, 0x1.9367a05ae38d3p-56, 0x1.8af2c8dafcb08p-57,
+			0x1.7605a4748480ap-56, 0x1.6e8920c09b73fp-58, 0x1.e6c2bdfb3e037p-58, 0x1.aacfdbbdab914p-56,
+			0x1.58cb3124b9245p-56, 0x1.9964a168ccacap-57, 0x1.2b125247b0fa5p-56, -0x1.83d680d3c1084p-56,
+			0x1.ce2b31b31e8b0p-58, 0x1.cd55b8a4746c0p-58, -0x1.8251a3b83d97ap-62, 0x1.856e61c515740p-57,
+			-0x1.bb75d1addf870p-60, -0x1.512c3749a1e4ep-56, -0x1.7b9d68d50a15dp-56, -0x1.e0936abd4fa6ep-62,
+			0x1.92b49ef282b09p-57, -0x1.43c2e68684d53p-57, 0x1.0779634061cbcp-56, -0x1.8de00938b4c40p-61,
+			0x1.27c77ded76aadp-58, 0x1.d33919ab94074p-57, -0x1.fea48dd7b81d1p-58, 0x1.c0df841a71b7ap-57,
+			-0x1.53d154280394fp-57, -0x1.f11aa3853a5f1p-57, -0x1.a0ee735d9f0ecp-60, -0x1.ab5ca9eaa088ap-57,
+			-0x1.df207dc5c34c6p-58, -0x1.f47dfd871f87fp-57, -0x1.054473941ad99p-57, -0x1.d685f35eea2a0p-57,
+			0x1.ac5f0c075b847p-59, 0x1.521a000b4cf01p-57, -0x1.96332bd4b341fp-57, 0x1.5b2623e05016bp-58,
+			-0x1.4f4d710fec38ep-57, 0x1.927d47803c5f4p-57, 0x1.629c46c186385p-58, -0x1.70d6cdf05266cp-60,
+			0x1.c4716bdfc0cc9p-58, 0x1.6394d9fa33311p-57, -0x1.62c9ef939ac5dp-59, 0x1.2d56ff61c2bfbp-57,
+			0x1.692a0055dc959p-57, -0x1.39e2d3f8b7d10p-57, 0x1.9361574fb24e2p-58, -0x1.09ccecd579d99p-58,
+			-0x1.9daf7df76ad2ap-59, 0x1.cdc9f6f5f38c7p-59, -0x1.37d8f39bee659p-58, -0x1.fb0be3ccc1532p-59,
+			0x1.fa83214904842p-59, -0x1.abca5b4fdb880p-58, 0x1.9acd8b33f8fdcp-58, 0x1.45f9d61c68c1bp-58,
+			-0x1.1ba349aadbc6ep-58, -0x1.a92afc8ef70b1p-58, 0x1.cc0fbce104eaap-58, 0x1.a4a128d192686p-58,
+			0x1.cd9f1f95c2eedp-59, -0x1.4e6c986f44c55p-59, -0x1.e5cf3a0f56f72p-60, 0x1.727626c86b3abp-59,
+			-0x1.e5ef898b67923p-59, 0x1.bbf88ec501b56p-61, 0x1.50830a65543a4p-63, 0x1.53482d1f9d7d7p-61,
+			-0x1.75b44595cab18p-60, -0x1.ec1a5f86d41f9p-62, 0x1.8ed4d357c9c97p-64, 0x1.cd7b66e01c26dp-61,
+			-0x1.806208c04c220p-61, 0x1.c5517f64bc223p-61, -0x1.c14b9f9377a1dp-65, 0x0p+0,
+			0x0p+0, -0x1.16d7687d3df21p-62, -0x1.0cb5a902b3a1cp-62, -0x1.0ae69229dc868p-64,
+			-0x1.e9ae889bac481p-60, -0x1.ce55c2b4e2b72p-59, 0x1.f5a0e80520bf2p-59, 0x1.1e3c53257fd47p-61,
+			0x1.80da5333c45b8p-59, -0x1.c125963fc4cfdp-62, 0x1.ddd4f935996c9p-59, -0x1.388458ec21b6ap-58,
+			-0x1.eeedfcdd94131p-58, -0x1.2099e1c184e8ep-59, 0x1.0878cf0327e21p-61, 0x1.790dd951d90fap-58,
+			0x1.85f325c5bbacdp-58, 0x1.50c647eb86499p-58, 0x1.a28813e3a7f07p-57, 0x1.f547bf1809e88p-57,
+			-0x1.6b9c7d96091fap-63, -0x1.ab3a8e7d81017p-58, 0x1.68981bcc36756p-57, -0x1.65d22aa8ad7cfp-58,
+			-0x1.0900e4e1ea8b2p-58, -0x1.b264062a84cdbp-58, -0x1.4be48073a0564p-58, -0x1.569d851a56770p-57,
+			0x1.575e31f003e0cp-57, -0x1.e8c37918c39ebp-58, 0x1.ba27fdc19e1a0p-57, -0x1.73dee38a3fb6bp-57,
+			0x1.239a07d55b695p-57, 0x1.834c51998b6fcp-57, -0x1.6e03a39bfc89bp-59, 0x1.c5f6dfd018c37p-61,
+			-0x1.cb9568ff6feadp-57, 0x1.d1707f97bde80p-58, 0x1.03ec81c3cbd92p-57, 0x1.7b66298edd24ap-56,
+			0x1.9d3d1b0e4d147p-56, -0x1.c9fdf9a0c4b07p-56, -0x1.0f76c57075e9ep-58, -0x1.896b5fd852ad4p-56,
+			-0x1.51acc4c09b379p-60, -0x1.b5629d8117de7p-59, -0x1.e3265c6a1c98dp-56, -0x1.29931715ac903p-56
+		},
+		// log10C
+		{
+			-0x1.4abe0649ad606p-3, -0x1.45b79b45c8551p-3, -0x1.40b86a657ca3dp-3, -0x1.3bc05efcbb185p-3,
+			-0x1.36cf64b7a82e6p-3, -0x1.31e56798a910ap-3, -0x1.2d0253f67e4cbp-3, -0x1.2826167a6bc9cp-3,
+			-0x1.23509c1e6d937p-3, -0x1.1e81d22b790d4p-3, -0x1.19b9a637ca295p-3, -0x1.14f806253c3edp-3,
+			-0x1.103ce01fae223p-3, -0x1.0b88229b71227p-3, -0x1.06d9bc53c2941p-3, -0x1.02319c494f951p-3,
+			-0x1.fb1f6381856f4p-4, -0x1.f1e7d882b689ap-4, -0x1.e8bc77271b97ap-4, -0x1.df9d1f7f5b674p-4,
+			-0x1.d689b2193f133p-4, -0x1.cd820ffd278f3p-4, -0x1.c4861aab93a23p-4, -0x1.bb95b41ab5ce6p-4,
+			-0x1.b2b0beb419ad0p-4, -0x1.a9d71d5258484p-4, -0x1.a108b33edb005p-4, -0x1.9845642fac8f0p-4,
+			-0x1.8f8d144557bdfp-4, -0x1.86dfa808d36a0p-4, -0x1.7e3d04697b704p-4, -0x1.75a50ebb1624ap-4,
+			-0x1.6d17acb3e5f5ep-4, -0x1.6494c46ac6e4dp-4, -0x1.5c1c3c5557799p-4, -0x1.53adfb462ce16p-4,
+			-0x1.4b49e86b11e5fp-4, -0x1.42efeb4b506e9p-4, -0x1.3a9febc60540ap-4, -0x1.3259d2107db54p-4,
+			-0x1.2a1d86b49f1e2p-4, -0x1.21eaf28f57941p-4, -0x1.19c1fecf17ee0p-4, -0x1.11a294f2569f6p-4,
+			-0x1.098c9ec61b3ffp-4, -0x1.0180066492817p-4, -0x1.f2f96c6754aeep-5, -0x1.e30531c76c34ap-5,
+			-0x1.d32332dc34dbdp-5, -0x1.c3534628016ddp-5, -0x1.b39542ba23d73p-5, -0x1.a3e9002c711d2p-5,
+			-0x1.944e56a0d3450p-5, -0x1.84c51ebee8d15p-5, -0x1.754d31b1b179cp-5, -0x1.65e6692547c4ep-5,
+			-0x1.56909f44a72fep-5, -0x1.474baeb77e904p-5, -0x1.381772a00e604p-5, -0x1.28f3c69912a74p-5,
+			-0x1.19e086b3b8333p-5, -0x1.0add8f759cd95p-5, -0x1.f7d57badb4ee8p-6, -0x1.da0fde8038de9p-6,
+			-0x1.bc6a03117eb97p-6, -0x1.9ee3a5e9f57e8p-6, -0x1.817c846828bbdp-6, -0x1.64345cbd3a491p-6,
+			-0x1.470aede96e7f2p-6, -0x1.29fff7b8ca79dp-6, -0x1.0d133abfc3f1bp-6, -0x1.e088f0b004827p-7,
+			-0x1.a726e53a6056ep-7, -0x1.6dffd8d3bbf70p-7, -0x1.351352a8e733fp-7, -0x1.f8c1b6b0c8d4ep-8,
+			-0x1.87cff9d9147a5p-8, -0x1.175085ab85ff0p-8, -0x1.4e84e793a474ap-9, 0x0p+0,
+			0x0p+0, 0x1.4b99563d2a1bdp-8, 0x1.1344daa2d7553p-7, 0x1.7fe71ccc4e6b0p-7,
+			0x1.ebb6af653e2eep-7, 0x1.2b5b5ec0209d3p-6, 0x1.60753003a94efp-6, 0x1.952a4f22c5ae9p-6,
+			0x1.c97c3735e7c0ap-6, 0x1.fd6c5b0851c4cp-6, 0x1.187e12aad8077p-5, 0x1.32167c82bdcdap-5,
+			0x1.4b8018b21ed4fp-5, 0x1.64bb912d65c07p-5, 0x1.7dc98c51c8242p-5, 0x1.96aaacfefcf3cp-5,
+			0x1.af5f92b00e610p-5, 0x1.c7e8d993509f9p-5, 0x1.e0471aa1868f5p-5, 0x1.f87aebb43ce06p-5,
+			0x1.08426fcdb1ee7p-4, 0x1.1432c31917d08p-4, 0x1.200eb639a3173p-4, 0x1.2bd68e4621371p-4,
+			0x1.378a8ef84971ep-4, 0x1.432afab5dd3ffp-4, 0x1.4eb812997cde4p-4, 0x1.5a32167b32f02p-4,
+			0x1.659944f8ba02dp-4, 0x1.70eddb7d7ea07p-4, 0x1.7c30164a60836p-4, 0x1.8760307d355abp-4,
+			0x1.927e64180f790p-4, 0x1.9d8aea084aa9cp-4, 0x1.a885fa2d6151ep-4, 0x1.b36fcb5f8be8ap-4,
+			0x1.be4893762cbf7p-4, 0x1.c910874e09f98p-4, 0x1.d3c7dacf5780bp-4, 0x1.de6ec0f392b05p-4,
+			0x1.e9056bcb315e8p-4, 0x1.f38c0c8325d86p-4, 0x1.fe02d36a3956dp-4, 0x1.0434f7fb1f307p-3,
+			0x1.0960c8648e406p-3, 0x1.0e84f1dadb526p-3, 0x1.13a18ae256b99p-3, 0x1.18b6a99c7f679p-3
+		},
+		// log10CLow
+		{
+			0x1.82b1e7581b339p-57, -0x1.942014665011ap-57, 0x1.6b17a10a115e7p-58, 0x1.c9920bddba6eap-57,
+			0x1.b903e6347000fp-59, -0x1.4b79d1957630ap-58, 0x1.3dda694b5fe22p-57, -0x1.557d4cdeffe3fp-57,
+			-0x1.ea54c137b0aeap-57, -0x1.db81c3374e59ep-57, 0x1.e785b3b894bd7p-57, 0x1.1f5da9e930834p-57,
+			-0x1.dbdf176a1440ap-59, 0x1.09801174f88fdp-57, 0x1.c8447816ecacbp-58, -0x1.ef8dd8b73f78dp-59,
+			0x1.6749ac407ee87p-59, -0x1.0955b9d99c1b8p-58, 0x1.7240569ddebccp-58, -0x1.5c6bc5d06e932p-58,
+			0x1.100072d011b81p-62, 0x1.8f377e27bbe25p-58, 0x1.b6b51fca7a9a5p-58, 0x1.cb0a198331cafp-58,
+			-0x1.5689de26b43ffp-59, 0x1.f648977febad9p-59, -0x1.ba75ea17687d3p-58, -0x1.a9966e9c1f6b1p-58,
+			-0x1.2034e6320e8c0p-65, 0x1.376c04717405ep-58, 0x1.d12e032a3b7afp-59, -0x1.e4ba167ee73ddp-59,
+			0x1.2a2d69cfac78fp-58, -0x1.ad1738d96af06p-58, -0x1.81f647ea24688p-59, -0x1.bc478d6071be0p-59,
+			0x1.4f0487863efe6p-58, 0x1.8fb6b118c310fp-58, 0x1.514fb6a33e70fp-58, -0x1.d2b999f265be1p-58,
+			-0x1.85a155bb65408p-58, -0x1.a0dec3a5a500cp-58, -0x1.f8f29aae9c4d3p-59, 0x1.cae3496ce9852p-58,
+			-0x1.466dc013d46a9p-58, -0x1.bf9d17f86ca55p-59, 0x1.3a73e99099cbdp-61, -0x1.32de632195123p-60,
+			-0x1.b7f1b2883e205p-59, 0x1.0859ccb55560ep-59, -0x1.6591c969ff97bp-60, -0x1.5f23434e17d46p-59,
+			0x1.76df54932f73ep-59, -0x1.54596cc7150a8p-59, -0x1.ea90ccf791593p-60, -0x1.856c063a9d0bcp-59,
+			0x1.20d44f3d6bd97p-60, 0x1.197beb0be1c78p-61, 0x1.1b16a272d4ddfp-62, -0x1.c756ef644213dp-60,
+			-0x1.60fea21f201b9p-59, -0x1.4424000282546p-60, 0x1.9dc1111e3b44cp-61, 0x1.4a65cdeb626cap-60,
+			-0x1.999ccc6d592f0p-63, -0x1.be24ddca8b835p-63, -0x1.c830373882139p-60, 0x1.82e7594f180b4p-60,
+			0x1.fcdb87b8bc64dp-62, -0x1.6210c78e102c6p-61, 0x1.bda9c038e3dccp-60, 0x1.e607eb2a3908bp-62,
+			0x1.b41d4e4ac05d4p-61, -0x1.bc0294772c57fp-62, -0x1.2495d8b8e25b7p-61, 0x1.e4f45b8df7d67p-65,
+			-0x1.e1d6052707e0ep-63, -0x1.1e6c1240ced74p-62, -0x1.dcbdc594292c0p-63, 0x0p+0,
+			0x0p+0, 0x1.fb495d6440f14p-65, -0x1.9383502395c53p-61, 0x1.8d4a223a5f7c9p-61,
+			0x1.b57b9aec33450p-62, 0x1.5bcd6d3458191p-62, 0x1.6ea248137e395p-60, -0x1.f21279ca1bd16p-62,
+			0x1.f6e5bfd132ef3p-61, -0x1.e7ffa709828efp-60, 0x1.9adc1c7f97f4ap-59, -0x1.92b9251ee5832p-59,
+			0x1.43795bbf70657p-59, 0x1.eff9decc696f6p-61, 0x1.3acab34123660p-59, -0x1.1c8c309cdac54p-59,
+			-0x1.6487d64961833p-59, -0x1.073b6859dc799p-59, -0x1.d4d643174a412p-59, -0x1.1436f936096a0p-60,
+			-0x1.ccc49eb0a89d8p-60, -0x1.114d5dc0b3275p-59, -0x1.c2f24fb8a820dp-58, 0x1.9f5fa977fa091p-58,
+			0x1.8847c4d88be3fp-60, -0x1.1960cbdfcb2d3p-58, -0x1.65e8d55b1fb7dp-58, 0x1.8cb0dc78c3961p-59,
+			-0x1.9d9c8eaf88500p-58, 0x1.8bed80098b7d8p-58, 0x1.1064a1f6dc0c5p-61, -0x1.666804e99aabcp-60,
+			-0x1.a6d8c9497109fp-60, -0x1.4945caae41546p-60, -0x1.dd366189ac022p-58, -0x1.aa2aeaa7bc18dp-58,
+			-0x1.97c05c8f44e46p-58, 0x1.ae12046c1aaddp-58, -0x1.a29b8965a6c39p-59, -0x1.1bf355bb72ca1p-58,
+			-0x1.3cbb5a6ee659bp-58, -0x1.4a69937a2d705p-58, 0x1.8f79d63a994c3p-58, -0x1.00052af97037fp-57,
+			0x1.62350c9785c5fp-57, 0x1.574d5e4d23b1cp-57, -0x1.8bca24bbe78e8p-57, -0x1.d6679f737585cp-58
+		}
+	};
+
+}
@@ -0,0 +1,440 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <cfloat>
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace orchestracpp
+{
+
+	/**
+	 * Fast kernels for the transcendental functions that dominate the evaluation of
+	 * chemical systems: 10^x, log10(x), exp(x) and log(x).
+	 *
+	 * The standard library functions are correctly rounded or nearly so, but they are
+	 * called through the libm entry points and handle every special case on the way
+	 * (and std::pow(10, x) is a general power function). These kernels reduce the
+	 * argument with a table of 128 entries per binade and evaluate a short polynomial.
+	 * The only branch is the range check that passes rare arguments to the standard library,
+	 * so they inline in the interpreter loops and map one to one onto SIMD instructions
+	 * (the table lookups become gathers).
+	 *
+	 * Accuracy: the maximum error is 1.13 ulp for exp10 and exp, and 1.51 ulp for log10 and
+	 * log (std::log10 itself has 1.6 ulp), with and without FMA instructions, measured against
+	 * long double references on 10^8 arguments per range, see mathbenchmark.cpp. For log10
+	 * close to 1 (0.95 < x < 1.05) the maximum error is 1.21 ulp. Arguments outside the range of the kernels (|x| > 307 for
+	 * exp10, |x| > 705 for exp, zero, negative, subnormal, infinite or NaN arguments of
+	 * the logarithms) are passed to the standard library, so the special values are the
+	 * same as in strict mode.
+	 *
+	 * The array versions use AVX-512 or AVX2 when the code is compiled for it
+	 * (e.g. -march=native, /arch:AVX2) and give exactly the same results as the scalar
+	 * versions: all lanes execute the same sequence of operations, and a multiply-add is
+	 * fused in both or in neither, depending on whether FMA instructions are available.
+	 *
+	 * Calculators use the standard library (strict mode) unless the @fastmath: keyword
+	 * is present in the input file.
+	 */
+	class FastMath
+	{
+
+	public:
+
+		static inline double exp10(double x)
+		{
+			return apply<Scalar, Exp10Kernel>(x);
+		}
+
+		static inline double exp(double x)
+		{
+			return apply<Scalar, ExpKernel>(x);
+		}
+
+		static inline double log10(double x)
+		{
+			return apply<Scalar, Log10Kernel>(x);
+		}
+
+		static inline double log(double x)
+		{
+			return apply<Scalar, LogKernel>(x);
+		}
+
+		/**
+		 * Array versions: result[i] = f(x[i]) for i < n. The result may be the same array as x.
+		 */
+		static void exp10(const double* x, double* result, int n)
+		{
+			applyArray<Exp10Kernel>(x, result, n);
+		}
+
+		static void exp(const double* x, double* result, int n)
+		{
+			applyArray<ExpKernel>(x, result, n);
+		}
+
+		static void log10(const double* x, double* result, int n)
+		{
+			applyArray<Log10Kernel>(x, result, n);
+		}
+
+		static void log(const double* x, double* result, int n)
+		{
+			applyArray<LogKernel>(x, result, n);
+		}
+
+		/**
+		 * The instruction set used by the array versions.
+		 */
+		static const char* simdName()
+		{
+#if defined(__AVX512F__)
+			return "AVX-512";
+#elif defined(__AVX2__)
+			return "AVX2";
+#else
+			return "none";
+#endif
+		}
+
+	private:
+
+		// the reduction steps are multiples of 1/128 of a binade, the high parts of the
+		// Cody-Waite constants have at most 35 significant bits, so multiplying them by
+		// the integer n (|n| < 2^17) is exact
+		static constexpr double SHIFTER = 0x1.8p52;                        // adding this rounds to an integer
+		static constexpr double LOG2_10_128 = 0x1.a934f0979a371p+8;        // 128 log2(10)
+		static constexpr double LOG10_2_128_HI = 0x1.3441350a00000p-9;     // log10(2) / 128
+		static constexpr double LOG10_2_128_LO = -0x1.0c0219dc1da99p-46;
+		static constexpr double INV_LN2_128 = 0x1.71547652b82fep+7;        // 128 / ln(2)
+		static constexpr double LN2_128_HI = 0x1.62e42fefc0000p-8;         // ln(2) / 128
+		static constexpr double LN2_128_LO = -0x1.c610ca86c3899p-44;
+		static constexpr double LN10 = 0x1.26bb1bbb55516p+1;               // ln(10)
+		// the high parts have 42 significant bits, k * high is exact for the exponent k
+		static constexpr double LN2_HI = 0x1.62e42fefa3800p-1;             // ln(2)
+		static constexpr double LN2_LO = 0x1.ef35793c76730p-45;
+		static constexpr double LOG10_2_HI = 0x1.34413509f7800p-2;         // log10(2)
+		static constexpr double LOG10_2_LO = 0x1.fef311f12b358p-46;
+		static constexpr double LOG10_E = 0x1.bcb7b1526e50ep-2;            // log10(e)
+		// the high part has 27 significant bits, its product with r rounded to 26 bits is exact
+		static constexpr double LOG10_E_HI = 0x1.bcb7b14000000p-2;
+		static constexpr double LOG10_E_LO = 0x1.26e50e32a6ab7p-30;
+		static constexpr uint64_t HIGH_26_BITS = ~0x7ffffffULL;            // clears the low 27 bits of the mantissa
+		static constexpr uint64_t SHIFTER_BITS = 0x4338000000000000ULL;    // bits of SHIFTER
+		static constexpr uint64_t EXPONENT_BIAS = 1023ULL << 52;
+		static constexpr uint64_t LOG_OFFSET = 0x3fe6000000000000ULL;      // bits of 0.6875
+
+		/**
+		 * 2^(j/128), j = 0..127
+		 */
+		static const double exp2Table[128];
+
+		/**
+		 * The logarithms split x in 2^k * z, 0.6875 <= z < 1.375. The interval of z is divided
+		 * in 128 subintervals, by the 7 bits below the exponent of z. For each subinterval,
+		 * c is its centre (exactly 1 for the two subintervals next to 1), invC the rounded 1/c,
+		 * and log(c) and log10(c) are split in a rounded value and the rest.
+		 */
+		struct LogTable
+		{
+			double c[128];
+			double invC[128];
+			double logC[128];
+			double logCLow[128];
+			double log10C[128];
+			double log10CLow[128];
+		};
+		static const LogTable logTable;
+
+		/**
+		 * The operations used by the kernels, on a single double.
+		 */
+		struct Scalar
+		{
+			typedef double D;
+			typedef uint64_t I;
+			static const int width = 1;
+
+			static inline D set(double a) { return a; }
+			static inline I setInt(uint64_t a) { return a; }
+			static inline D load(const double* p) { return *p; }
+			static inline void store(double* p, D a) { *p = a; }
+			static inline D gather(const double* table, I index) { return table[index]; }
+			static inline D add(D a, D b) { return a + b; }
+			static inline D sub(D a, D b) { return a - b; }
+			static inline D mul(D a, D b) { return a * b; }
+#ifdef __FMA__
+			static inline D mulAdd(D a, D b, D c) { return std::fma(a, b, c); }
+#else
+			static inline D mulAdd(D a, D b, D c) { return a * b + c; }
+#endif
+			static inline I bits(D a) { I i; std::memcpy(&i, &a, sizeof(i)); return i; }
+			static inline D fromBits(I i) { D a; std::memcpy(&a, &i, sizeof(a)); return a; }
+			static inline I addInt(I a, I b) { return a + b; }
+			static inline I subInt(I a, I b) { return a - b; }
+			static inline I andInt(I a, I b) { return a & b; }
+			template <int S> static inline I shiftLeft(I a) { return a << S; }
+			template <int S> static inline I shiftRight(I a) { return a >> S; }
+			static inline bool anyOutside(D a, double low, double high) { return !((a >= low) && (a <= high)); }
+		};
+
+#if defined(__AVX512F__)
+		struct Avx512
+		{
+			typedef __m512d D;
+			typedef __m512i I;
+			static const int width = 8;
+
+			static inline D set(double a) { return _mm512_set1_pd(a); }
+			static inline I setInt(uint64_t a) { return _mm512_set1_epi64((long long)a); }
+			static inline D load(const double* p) { return _mm512_loadu_pd(p); }
+			static inline void store(double* p, D a) { _mm512_storeu_pd(p, a); }
+			static inline D gather(const double* table, I index) { return _mm512_i64gather_pd(index, table, 8); }
+			static inline D add(D a, D b) { return _mm512_add_pd(a, b); }
+			static inline D sub(D a, D b) { return _mm512_sub_pd(a, b); }
+			static inline D mul(D a, D b) { return _mm512_mul_pd(a, b); }
+#ifdef __FMA__
+			static inline D mulAdd(D a, D b, D c) { return _mm512_fmadd_pd(a, b, c); }
+#else
+			static inline D mulAdd(D a, D b, D c) { return _mm512_add_pd(_mm512_mul_pd(a, b), c); }
+#endif
+			static inline I bits(D a) { return _mm512_castpd_si512(a); }
+			static inline D fromBits(I i) { return _mm512_castsi512_pd(i); }
+			static inline I addInt(I a, I b) { return _mm512_add_epi64(a, b); }
+			static inline I subInt(I a, I b) { return _mm512_sub_epi64(a, b); }
+			static inline I andInt(I a, I b) { return _mm512_and_si512(a, b); }
+			template <int S> static inline I shiftLeft(I a) { return _mm512_slli_epi64(a, S); }
+			template <int S> static inline I shiftRight(I a) { return _mm512_srli_epi64(a, S); }
+			static inline bool anyOutside(D a, double low, double high)
+			{
+				return (_mm512_cmp_pd_mask(a, set(low), _CMP_NGE_UQ) | _mm512_cmp_pd_mask(a, set(high), _CMP_NLE_UQ)) != 0;
+			}
+		};
+		typedef Avx512 Simd;
+#elif defined(__AVX2__)
+		struct Avx2
+		{
+			typedef __m256d D;
+			typedef __m256i I;
+			static const int width = 4;
+
+			static inline D set(double a) { return _mm256_set1_pd(a); }
+			static inline I setInt(uint64_t a) { return _mm256_set1_epi64x((long long)a); }
+			static inline D load(const double* p) { return _mm256_loadu_pd(p); }
+			static inline void store(double* p, D a) { _mm256_storeu_pd(p, a); }
+			static inline D gather(const double* table, I index) { return _mm256_i64gather_pd(table, index, 8); }
+			static inline D add(D a, D b) { return _mm256_add_pd(a, b); }
+			static inline D sub(D a, D b) { return _mm256_sub_pd(a, b); }
+			static inline D mul(D a, D b) { return _mm256_mul_pd(a, b); }
+#ifdef __FMA__
+			static inline D mulAdd(D a, D b, D c) { return _mm256_fmadd_pd(a, b, c); }
+#else
+			static inline D mulAdd(D a, D b, D c) { return _mm256_add_pd(_mm256_mul_pd(a, b), c); }
+#endif
+			static inline I bits(D a) { return _mm256_castpd_si256(a); }
+			static inline D fromBits(I i) { return _mm256_castsi256_pd(i); }
+			static inline I addInt(I a, I b) { return _mm256_add_epi64(a, b); }
+			static inline I subInt(I a, I b) { return _mm256_sub_epi64(a, b); }
+			static inline I andInt(I a, I b) { return _mm256_and_si256(a, b); }
+			template <int S> static inline I shiftLeft(I a) { return _mm256_slli_epi64(a, S); }
+			template <int S> static inline I shiftRight(I a) { return _mm256_srli_epi64(a, S); }
+			static inline bool anyOutside(D a, double low, double high)
+			{
+				return _mm256_movemask_pd(_mm256_or_pd(_mm256_cmp_pd(a, set(low), _CMP_NGE_UQ), _mm256_cmp_pd(a, set(high), _CMP_NLE_UQ))) != 0;
+			}
+		};
+		typedef Avx2 Simd;
+#endif
+
+		/**
+		 * 2^(n/128) * exp(u), where t = n + SHIFTER and |u| <= ln(2)/256.
+		 * exp(u) - 1 is a Taylor polynomial of degree 5 (truncation error below 0.01 ulp).
+		 */
+		template <class V>
+		static inline typename V::D exp2Scaled(typename V::D u, typename V::D t)
+		{
+			typedef typename V::D D;
+			typedef typename V::I I;
+			I n = V::subInt(V::bits(t), V::setInt(SHIFTER_BITS));
+			D table = V::gather(exp2Table, V::andInt(n, V::setInt(127)));
+			// add n / 128 (rounded down) to the exponent of the table value
+			D scale = V::fromBits(V::addInt(V::bits(table), V::template shiftLeft<45>(V::andInt(n, V::setInt(~127ULL)))));
+			D p = V::set(1.0 / 120.0);
+			p = V::mulAdd(p, u, V::set(1.0 / 24.0));
+			p = V::mulAdd(p, u, V::set(1.0 / 6.0));
+			p = V::mulAdd(p, u, V::set(0.5));
+			p = V::mulAdd(p, u, V::set(1.0));
+			return V::mulAdd(scale, V::mul(p, u), scale);
+		}
+
+		/**
+		 * Splits a positive normal x in 2^k * z and returns the table index i of z,
+		 * k (as a double) and r = (z - c) / c, |r| < 1/128.
+		 * log(x) = k log(2) + log(c) + log(1 + r).
+		 */
+		template <class V>
+		static inline typename V::I reduceLog(typename V::D x, typename V::D& k, typename V::D& r)
+		{
+			typedef typename V::I I;
+			I ix = V::bits(x);
+			I offset = V::subInt(ix, V::setInt(LOG_OFFSET));
+			I i = V::andInt(V::template shiftRight<45>(offset), V::setInt(127));
+			// the biased exponent, the addition can not overflow for normal x
+			I biasedK = V::template shiftRight<52>(V::addInt(offset, V::setInt(EXPONENT_BIAS)));
+			k = V::sub(V::fromBits(V::addInt(biasedK, V::setInt(SHIFTER_BITS))), V::set(SHIFTER + 1023.0));
+			typename V::D z = V::fromBits(V::subInt(ix, V::andInt(offset, V::setInt(0xfffULL << 52))));
+			// z - c is exact
+			r = V::mul(V::sub(z, V::gather(logTable.c, i)), V::gather(logTable.invC, i));
+			return i;
+		}
+
+		/**
+		 * (log(1 + r) - r) / r^2 for |r| < 1/128, Taylor polynomial of degree 6
+		 * (truncation error below 0.01 ulp).
+		 */
+		template <class V>
+		static inline typename V::D log1pPolynomial(typename V::D r)
+		{
+			typename V::D p = V::set(-1.0 / 8.0);
+			p = V::mulAdd(p, r, V::set(1.0 / 7.0));
+			p = V::mulAdd(p, r, V::set(-1.0 / 6.0));
+			p = V::mulAdd(p, r, V::set(1.0 / 5.0));
+			p = V::mulAdd(p, r, V::set(-1.0 / 4.0));
+			p = V::mulAdd(p, r, V::set(1.0 / 3.0));
+			return V::mulAdd(p, r, V::set(-0.5));
+		}
+
+		struct Exp10Kernel
+		{
+			static constexpr double low = -307.0;
+			static constexpr double high = 307.0;
+
+			static inline double fallback(double x) { return std::pow(10.0, x); }
+
+			template <class V>
+			static inline typename V::D evaluate(typename V::D x)
+			{
+				typedef typename V::D D;
+				D t = V::mulAdd(x, V::set(LOG2_10_128), V::set(SHIFTER));
+				D n = V::sub(t, V::set(SHIFTER));
+				D r = V::mulAdd(n, V::set(-LOG10_2_128_HI), x);
+				r = V::mulAdd(n, V::set(-LOG10_2_128_LO), r);
+				return exp2Scaled<V>(V::mul(r, V::set(LN10)), t);
+			}
+		};
+
+		struct ExpKernel
+		{
+			static constexpr double low = -705.0;
+			static constexpr double high = 705.0;
+
+			static inline double fallback(double x) { return std::exp(x); }
+
+			template <class V>
+			static inline typename V::D evaluate(typename V::D x)
+			{
+				typedef typename V::D D;
+				D t = V::mulAdd(x, V::set(INV_LN2_128), V::set(SHIFTER));
+				D n = V::sub(t, V::set(SHIFTER));
+				D r = V::mulAdd(n, V::set(-LN2_128_HI), x);
+				r = V::mulAdd(n, V::set(-LN2_128_LO), r);
+				return exp2Scaled<V>(r, t);
+			}
+		};
+
+		struct LogKernel
+		{
+			static constexpr double low = DBL_MIN;
+			static constexpr double high = DBL_MAX;
+
+			static inline double fallback(double x) { return std::log(x); }
+
+			template <class V>
+			static inline typename V::D evaluate(typename V::D x)
+			{
+				typedef typename V::D D;
+				D k;
+				D r;
+				typename V::I i = reduceLog<V>(x, k, r);
+				// hi + lo = k ln(2) + log(c) + r, exactly
+				D w = V::mulAdd(k, V::set(LN2_HI), V::gather(logTable.logC, i));
+				D hi = V::add(w, r);
+				D lo = V::add(V::sub(w, hi), r);
+				D tail = V::add(V::mulAdd(k, V::set(LN2_LO), V::gather(logTable.logCLow, i)), lo);
+				return V::add(hi, V::mulAdd(V::mul(r, r), log1pPolynomial<V>(r), tail));
+			}
+		};
+
+		struct Log10Kernel
+		{
+			static constexpr double low = DBL_MIN;
+			static constexpr double high = DBL_MAX;
+
+			static inline double fallback(double x) { return std::log10(x); }
+
+			template <class V>
+			static inline typename V::D evaluate(typename V::D x)
+			{
+				typedef typename V::D D;
+				D k;
+				D r;
+				typename V::I i = reduceLog<V>(x, k, r);
+				// r log10(e) = rLog10 + rest, rLog10 is exact so close to 1 (k = 0, c = 1) the
+				// result is not limited by the rounding of r log10(e)
+				D rHigh = V::fromBits(V::andInt(V::bits(r), V::setInt(HIGH_26_BITS)));
+				D rLog10 = V::mul(rHigh, V::set(LOG10_E_HI));
+				D rest = V::mulAdd(V::sub(r, rHigh), V::set(LOG10_E_HI), V::mul(r, V::set(LOG10_E_LO)));
+				D w = V::mulAdd(k, V::set(LOG10_2_HI), V::gather(logTable.log10C, i));
+				D hi = V::add(w, rLog10);
+				D lo = V::add(V::sub(w, hi), rLog10);
+				D tail = V::add(V::add(V::mulAdd(k, V::set(LOG10_2_LO), V::gather(logTable.log10CLow, i)), lo), rest);
+				return V::add(hi, V::mulAdd(V::mul(V::mul(r, r), log1pPolynomial<V>(r)), V::set(LOG10_E), tail));
+			}
+		};
+
+		template <class V, class K>
+		static inline double apply(double x)
+		{
+			if (V::anyOutside(x, K::low, K::high))
+			{
+				return K::fallback(x);
+			}
+			return K::template evaluate<V>(x);
+		}
+
+		template <class K>
+		static void applyArray(const double* x, double* result, int n)
+		{
+			int i = 0;
+#if defined(__AVX2__) || defined(__AVX512F__)
+			for (; i + Simd::width <= n; i += Simd::width)
+			{
+				typename Simd::D xs = Simd::load(x + i);
+				if (Simd::anyOutside(xs, K::low, K::high))
+				{
+					// rare, the arguments are kept because result may be the same array as x
+					double arguments[Simd::width];
+					Simd::store(arguments, xs);
+					for (int lane = 0; lane < Simd::width; lane++)
+					{
+						result[i + lane] = apply<Scalar, K>(arguments[lane]);
+					}
+				}
+				else
+				{
+					Simd::store(result + i, K::template evaluate<Simd>(xs));
+				}
+			}
+#endif
+			for (; i < n; i++)
+			{
+				result[i] = apply<Scalar, K>(x[i]);
+			}
+		}
+	};
+
+}
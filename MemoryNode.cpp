@@ -11,21 +11,72 @@ namespace orchestracpp
 
 	double MemoryNode::evaluate()
 	{
-		if (needsEvaluation)
+		if (reg < 0)
 		{
-			lastValue = child->evaluate();
-			needsEvaluation = false;
+			if (ownDirty)
+			{
+				ownLastValue = child->evaluate();
+				ownDirty = false;
+			}
+			return ownLastValue;
+		}
+
+		double* registers = VarGroupState::currentRegisters;
+		uint64_t* dirty = VarGroupState::currentDirtyMemoryNodes + dirtyWord;
+		if (*dirty & dirtyBit)
+		{
+			registers[reg] = child->evaluate();
+			*dirty &= ~dirtyBit;
 		}
-		return lastValue;
+		return registers[reg];
 	}
 
 	void MemoryNode::setDependentMemoryNode(MemoryNode *parent)
 	{
 		child->setDependentMemoryNode(parent);
 		if (!dependentMemoryNodesDone) {
+			topologicalOrder = parent->topologicalOrder;
 			child->setDependentMemoryNode(this);
 			dependentMemoryNodesDone = true;
+			// all memory nodes below this one are numbered now
+			setId();
+		}
+	}
+
+	void MemoryNode::setId()
+	{
+		if ((id < 0) && (topologicalOrder != nullptr))
+		{
+			id = (int)topologicalOrder->size();
+			topologicalOrder->push_back(this);
+		}
+	}
+
+	void MemoryNode::setRegister(int reg, int dirtyWord, uint64_t dirtyBit, VarGroupState& state)
+	{
+		state.registers[reg] = ownLastValue;
+		if (ownDirty)
+		{
+			state.dirtyMemoryNodes[dirtyWord] |= dirtyBit;
 		}
+		this->reg = reg;
+		this->dirtyWord = dirtyWord;
+		this->dirtyBit = dirtyBit;
+	}
+
+	int MemoryNode::compile(ExpressionProgram* program)
+	{
+		return program->compile(child);
+	}
+
+	void MemoryNode::getChildren(std::vector<ExpressionNode**>& children)
+	{
+		children.push_back(&child);
+	}
+
+	ExpressionNode* MemoryNode::copy(Parser* parser)
+	{
+		return new (parser) MemoryNode(*this);
 	}
 
 	bool MemoryNode::constant()
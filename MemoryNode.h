@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstdint>
+#include <vector>
 #include "ExpressionNode.h"
+#include "VarGroupState.h"
 
 // Forward class declarations:
 namespace orchestracpp { class ExpressionNode; }
@@ -20,15 +23,44 @@ namespace orchestracpp
 	class MemoryNode final: public ExpressionNode
 	{ //-----------------------------------------
 
-	public:
-		bool needsEvaluation = true;
 	private:
-		double lastValue = 0;
 		bool dependentMemoryNodesDone = false;
+
+		// Until the memory nodes are numbered, the last value and dirty flag are stored in the node itself.
+		// After numbering they are a register and a bit in the (current) VarGroupState.
+		double ownLastValue = 0;
+		bool ownDirty = true;
+		int reg = -1;
+		int dirtyWord = 0;
+		uint64_t dirtyBit = 1;
 	public:
 		ExpressionNode *child = nullptr;
 		int nrReferences = 0;
 
+		int id = -1; // position in the topological order, children come before their parents
+		std::vector<MemoryNode*>* topologicalOrder = nullptr;
+
+		inline bool needsEvaluation()
+		{
+			return (reg < 0) ? ownDirty : ((VarGroupState::currentDirtyMemoryNodes[dirtyWord] & dirtyBit) != 0);
+		}
+
+		inline void invalidate()
+		{
+			if (reg < 0) ownDirty = true;
+			else VarGroupState::currentDirtyMemoryNodes[dirtyWord] |= dirtyBit;
+		}
+
+		/**
+		 * Adds this node to the topological order, after all nodes it depends on.
+		 */
+		void setId();
+
+		/**
+		 * Move the last value and dirty flag of this node to a register and a bit in the dirty bitset of the VarGroup.
+		 */
+		void setRegister(int reg, int dirtyWord, uint64_t dirtyBit, VarGroupState& state);
+
 		~MemoryNode()
 		{
 		//	delete child;
@@ -49,6 +81,16 @@ namespace orchestracpp
 		 */
 		ExpressionNode *optimize(Parser* parser) override;
 
+		/**
+		 * A memory node does not need an instruction in a compiled program, the
+		 * register of its child already stores the intermediate result.
+		 */
+		int compile(ExpressionProgram* program) override;
+
+		void getChildren(std::vector<ExpressionNode**>& children) override;
+
+		ExpressionNode* copy(Parser* parser) override;
+
 	//    public String toString() {
 	//        return "M(" + child.toString() + ")";
 	//    }
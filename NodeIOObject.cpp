@@ -64,4 +64,21 @@ namespace orchestracpp
 			}
 		}
 	}
+
+	void NodeIOObject::getVariables(std::vector<Var*>& result)
+	{
+		for (auto p : toGlobalList) {
+			result.push_back(p->localVar);
+		}
+	}
+
+	int NodeIOObject::getNodeIndex(Var* local)
+	{
+		for (auto p : toLocalList) {
+			if ((p->localVar == local) && !local->immutable) {
+				return p->nodeVarIndex;
+			}
+		}
+		return -1;
+	}
 }
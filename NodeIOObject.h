@@ -77,6 +77,17 @@ namespace orchestracpp
 		void copyToGlobal(Node *globalNode);
 
 		void copyToGlobalFromCalculator(Node *globalNode);
+
+		/**
+		 * Adds the local variables that are exchanged with the node.
+		 */
+		void getVariables(std::vector<Var*>& result);
+
+		/**
+		 * Returns the index of the node variable that is copied to this local variable,
+		 * or -1 if the local variable does not get its value from the node.
+		 */
+		int getNodeIndex(Var* local);
 	};
 
 }
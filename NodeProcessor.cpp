@@ -35,6 +35,10 @@ namespace orchestracpp
 			cout << "first calculation was successful " << endl;
 
 			calculators.push_back(tmpCalculator);
+
+			StopFlag* threadFlag = new StopFlag();
+			sf->addChild(threadFlag);
+			threadFlags.push_back(threadFlag);
 		}
 
 		startProcessing = false;
@@ -44,7 +48,7 @@ namespace orchestracpp
 
 		for (int n = 0; n < this->nrThreads; n++) {
 			// each thread has its own independent calculator, so these can run in parallel
-			threads.push_back(new std::thread(&NodeProcessor::runf, this, calculators.at(n)));
+			threads.push_back(new std::thread(&NodeProcessor::runf, this, calculators.at(n), threadFlags.at(n)));
 		}
 	}
 
@@ -61,9 +65,12 @@ namespace orchestracpp
 	void NodeProcessor::processNodes(vector<Node*>* nodes) {
 
 		this->nodes = nodes;
+		retryNodes.clear();
+		nrRetriedNodes = 0;
 
 		if (nrThreads == 1) {
 			processNodesSingleThread(nodes, memoryOption);
+			processRetryNodes();
 			return;
 		}
 
@@ -80,6 +87,14 @@ namespace orchestracpp
 			}
 	    }
 
+		processBatch();
+
+		// The stragglers are calculated after the main batch, so they do not hold up the other nodes
+		processRetryNodes();
+	}
+
+	void NodeProcessor::processBatch() {
+
 		// initialize the flag variables and 
 		// notify threads that they can start processing
 		{
@@ -113,6 +128,79 @@ namespace orchestracpp
 
 	}
 
+	// Recalculate the nodes that exceeded the time budget, without deadline, with stronger calculator settings
+	// and one node at the time so these are spread over all threads
+	void NodeProcessor::processRetryNodes() {
+
+		if (retryNodes.empty() || sf->isCancelled()) {
+			return;
+		}
+
+		vector<Node*>* mainNodes = nodes;
+		int mainSetSize = setSize;
+
+		vector<Node*> tmpNodes;
+		tmpNodes.swap(retryNodes);
+		nrRetriedNodes = tmpNodes.size();
+
+		for (Calculator* c : calculators) {
+			c->setRetryMode(true);
+		}
+		retrying = true;
+		nodes = &tmpNodes;
+		setSize = 1;
+
+		if (nrThreads == 1) {
+			for (int n = 0; n < tmpNodes.size(); n++) {
+				calculateNode(calculators.at(0), tmpNodes.at(n), threadFlags.at(0));
+			}
+		}
+		else {
+			processBatch();
+		}
+
+		for (Calculator* c : calculators) {
+			c->setRetryMode(false);
+		}
+		retrying = false;
+		nodes = mainNodes;
+		setSize = mainSetSize;
+	}
+
+	// The lockstep batches are used for independent nodes without a time budget
+	bool NodeProcessor::useBatches(Calculator* c) {
+		return (c->batchWidth > 0) && (memoryOption == 0) && (nodeTimeBudget == 0) && !retrying;
+	}
+
+	// Calculate a single node, and put it in the retry queue if it failed because it ran out of time
+	bool NodeProcessor::calculateNode(Calculator* c, Node* node, StopFlag* flag) {
+
+		flag->setDeadline(retrying ? 0 : nodeTimeBudget);
+
+		// a node that runs out of time is retried from its original values, not from the aborted state
+		Node* original = (!retrying && (nodeTimeBudget > 0)) ? node->clone() : nullptr;
+
+		bool success;
+		if (memoryOption == 0) { // no memory, simply use current node as start estimation
+			success = c->calculate(node, flag);
+		}
+		else { // use last calculated node as start estimation
+			success = c->calculate2(node, flag);
+		}
+
+		if (!success && flag->deadlinePassed() && !sf->isCancelled()) {
+			if (original != nullptr) {
+				node->clone(original);
+			}
+			std::lock_guard<mutex> lock(mtx);
+			retryNodes.push_back(node);
+		}
+		delete original;
+
+		flag->setDeadline(0);
+		return success;
+	}
+
 
 	/*
 	int NodeProcessor::partition(vector<Node*>* nodes, int low, int high) {
@@ -219,6 +307,20 @@ namespace orchestracpp
 	}
 	//*/
 
+	void NodeProcessor::setToleranceFactor(double factor) {
+		// only called between batches, when the worker threads are waiting
+		for (Calculator* c : calculators) {
+			c->setToleranceFactor(factor);
+		}
+	}
+
+	void NodeProcessor::setParameter(const std::string& parameterName, double value) {
+		// only called between batches, when the worker threads are waiting
+		for (Calculator* c : calculators) {
+			c->setParameter(parameterName, value);
+		}
+	}
+
 	void NodeProcessor::pleaseStop() {
 		std::lock_guard<mutex> lock(mtx);
 		quit = true;
@@ -266,7 +368,7 @@ namespace orchestracpp
 	
 	//*
 	// This version processes a set of nodes at the time
-	void NodeProcessor::runf(Calculator* c) {
+	void NodeProcessor::runf(Calculator* c, StopFlag* flag) {
 
 		while (true) {
 
@@ -291,15 +393,13 @@ namespace orchestracpp
 				}
 
 
-				if (memoryOption == 0) { // no memory, simply use current node as start estimation
-	
-				    for (int n = 0; n < ntbc->size(); n++) {
-						c->calculate(ntbc->at(n), sf);
-					}
+				if (useBatches(c)) {
+					c->calculateBatch(*ntbc, flag);
 				}
 				else {
-					for (int n = 0; n < ntbc->size(); n++) { // use last calculated node as start estimation
-						c->calculate2(ntbc->at(n), sf);
+					c->shareBatchInputs(*ntbc);
+					for (int n = 0; n < ntbc->size(); n++) {
+						calculateNode(c, ntbc->at(n), flag);
 					}
 				}
 
@@ -317,15 +417,14 @@ namespace orchestracpp
 
 		Calculator* c = calculators.at(0);
 
-		if (memoryOption == 0) { // no memory, simply use current node as start estimation
-			for (int n = 0; n < nodes->size(); n++) {
-				c->calculate(nodes->at(n), sf);
-			}
+		if (useBatches(c)) {
+			c->calculateBatch(*nodes, threadFlags.at(0));
+			return;
 		}
-		else {
-			for (int n = 0; n < nodes->size(); n++) { // use last calculated node as start estimation
-				c->calculate2(nodes->at(n), sf);
-			}
+
+		c->shareBatchInputs(*nodes);
+		for (int n = 0; n < nodes->size(); n++) {
+			calculateNode(c, nodes->at(n), threadFlags.at(0));
 		}
 
 	}
@@ -24,6 +24,7 @@ namespace orchestracpp
 
 	private:
 		vector<Calculator*> calculators;
+		vector<StopFlag*> threadFlags; // one child flag per thread, used for the per node deadline
 		std::vector<thread*> threads;
 		vector<Node*>* nodes = nullptr;
 		int currentNodeNr = 0;
@@ -46,10 +47,16 @@ namespace orchestracpp
 
 		int setSize = 1;
 
+		vector<Node*> retryNodes; // nodes that exceeded the time budget, recalculated after the main batch
+		bool retrying = false;
+
 	public:
 
 		int nrThreads = 0;
 
+		double nodeTimeBudget = 0; // maximum wall clock time (seconds) per node in the main batch, 0 = no limit
+		int nrRetriedNodes = 0;    // number of nodes that were deferred to the retry queue in the last processNodes call
+
 		~NodeProcessor() { // Delete all the created calculators
 
 			pleaseStop();
@@ -64,6 +71,11 @@ namespace orchestracpp
 				delete c;
 			}
 
+			for (StopFlag* f : threadFlags) {
+				sf->removeChild(f);
+				delete f;
+			}
+
 		}
 
 		NodeProcessor(Calculator*, int, StopFlag*, vector<Node*>* nodes);
@@ -74,6 +86,12 @@ namespace orchestracpp
 
 		void pleaseStop();
 
+		// scale the equation tolerances of all calculators for the next batches (1 = full accuracy)
+		void setToleranceFactor(double factor);
+
+		// change a parameter (@parameter:) of all calculators for the next batches
+		void setParameter(const std::string& parameterName, double value);
+
 		void processNodesSingleThread(vector<Node*>* nodes, int mo);
 
 	private:
@@ -82,7 +100,15 @@ namespace orchestracpp
 
 		vector<Node*>* getNextNodes();
 
-		void runf(Calculator* c);
+		void processBatch();
+
+		void processRetryNodes();
+
+		bool calculateNode(Calculator* c, Node* node, StopFlag* flag);
+
+		bool useBatches(Calculator* c);
+
+		void runf(Calculator* c, StopFlag* flag);
 
 		void incNrBusy();
 
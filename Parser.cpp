@@ -5,8 +5,11 @@
 
 #include "OrchestraException.h"
 #include "stringhelper.h"
+#include "FastMath.h"
 
 #include <sstream>
+#include <charconv>
+#include <cstring>
 
 namespace orchestracpp
 {
@@ -36,15 +39,178 @@ namespace orchestracpp
 	/* This method registers all new expressionnodes so they can be deleted upon destruction of the Parser object
 	*/
 	ExpressionNode* Parser::newNode(ExpressionNode* tmp) {
+		if (parsing) {
+			std::string key = tmp->structuralKey();
+			if (!key.empty()) {
+				auto found = sharedNodes.find(key);
+				if (found != sharedNodes.end()) {
+					// an identical node already exists, so we use its memory node
+					std::vector<ExpressionNode**> children;
+					tmp->getChildren(children);
+					// the children of the condition of an if node belong to the shared condition
+					releaseChildren(children, (typeid(*tmp) == typeid(IfNode)) ? children.size() - 2 : 0);
+					tmp->~ExpressionNode();
+					nrMergedNodes++;
+					found->second->nrReferences++;
+					return found->second;
+				}
+				allExpressionNodes.push_back(tmp);
+				MemoryNode* memory = new (this) MemoryNode(tmp);
+				memory->nrReferences = 1;
+				allExpressionNodes.push_back(memory);
+				sharedNodes.emplace(key, memory);
+				return memory;
+			}
+		}
 		allExpressionNodes.push_back(tmp);
 		return tmp;
 	}
 
 	BExpressionNode* Parser::newBNode(BExpressionNode* tmp) {
+		if (parsing) {
+			// conditions do not store a value, so they are shared without memory node
+			std::string key = tmp->structuralKey();
+			auto found = sharedBNodes.find(key);
+			if (found != sharedBNodes.end()) {
+				// the child of a not is a shared condition itself
+				if (typeid(*tmp) != typeid(Not)) {
+					std::vector<ExpressionNode**> children;
+					tmp->getChildren(children);
+					releaseChildren(children, 0);
+				}
+				delete tmp;
+				nrMergedNodes++;
+				return found->second;
+			}
+			sharedBNodes.emplace(key, tmp);
+		}
 		allBExpressionNodes.push_back(tmp);
 		return tmp;
 	}
 
+	void Parser::releaseChildren(std::vector<ExpressionNode**>& children, size_t first) {
+		for (size_t n = first; n < children.size(); n++) {
+			if (typeid(**children[n]) != typeid(MemoryNode)) {
+				continue;
+			}
+			MemoryNode* memory = static_cast<MemoryNode*>(*children[n]);
+			memory->nrReferences--;
+			auto shared = sharedNodes.find(memory->child->structuralKey());
+			if ((shared != sharedNodes.end()) && (shared->second == memory)) {
+				nrMergedNodes--;
+			}
+		}
+	}
+
+	void* ExpressionNode::operator new(std::size_t size, Parser* parser)
+	{
+		return parser->allocate(size);
+	}
+
+	void* Parser::allocate(std::size_t size)
+	{
+		const std::size_t alignment = alignof(std::max_align_t);
+		size = (size + alignment - 1) & ~(alignment - 1);
+
+		if (nodeBlocks.empty() || (blockUsed + size > blockSize))
+		{
+			nodeBlocks.push_back(new char[std::max(blockSize, size)]);
+			blockUsed = 0;
+		}
+		void* memory = nodeBlocks.back() + blockUsed;
+		blockUsed += size;
+		return memory;
+	}
+
+	int Parser::compact(std::vector<Var*>& roots)
+	{
+		std::vector<ExpressionNode*> oldNodes;
+		std::vector<char*> oldBlocks;
+		oldNodes.swap(allExpressionNodes);
+		oldBlocks.swap(nodeBlocks);
+		blockUsed = 0;
+
+		std::unordered_map<ExpressionNode*, ExpressionNode*> copies;
+		for (auto v : roots)
+		{
+			v->memory = (MemoryNode*)relocate(v->memory, copies);
+		}
+
+		// constants that are no longer used are removed
+		for (auto it = constants.begin(); it != constants.end(); )
+		{
+			auto found = copies.find(it->second);
+			if (found == copies.end())
+			{
+				it = constants.erase(it);
+			}
+			else
+			{
+				it->second = (NumberNode*)found->second;
+				++it;
+			}
+		}
+		sharedNodes.clear();
+		sharedBNodes.clear();
+
+		for (auto n : oldNodes)
+		{
+			n->~ExpressionNode();
+		}
+		for (auto b : oldBlocks)
+		{
+			delete[] b;
+		}
+
+		nrRemovedNodes = (int)(oldNodes.size() - allExpressionNodes.size());
+		return nrRemovedNodes;
+	}
+
+	ExpressionNode* Parser::relocate(ExpressionNode* node, std::unordered_map<ExpressionNode*, ExpressionNode*>& copies)
+	{
+		auto found = copies.find(node);
+		if (found != copies.end())
+		{
+			return found->second;
+		}
+
+		// the children first, so the nodes are stored in evaluation order
+		std::vector<ExpressionNode**> children;
+		node->getChildren(children);
+		std::vector<ExpressionNode*> newChildren;
+		for (auto child : children)
+		{
+			newChildren.push_back(relocate(*child, copies));
+		}
+
+		ExpressionNode* copy = node->copy(this);
+		if (copy != node)
+		{
+			allExpressionNodes.push_back(copy);
+		}
+
+		children.clear();
+		copy->getChildren(children);
+		for (size_t n = 0; n < children.size(); n++)
+		{
+			*children[n] = newChildren[n];
+		}
+
+		copies[node] = copy;
+		copies[copy] = copy;
+		return copy;
+	}
+
+	/* The structural key of a node consists of its type and the addresses of its children.
+	*  As the children are shared already, equal keys mean identical subexpressions.
+	*/
+	static std::string nodeKey(const char* type, const void* a, const void* b = nullptr, const void* c = nullptr)
+	{
+		std::ostringstream key;
+		key << type << ' ' << a << ' ' << b << ' ' << c;
+		return key.str();
+	}
+
 	double Parser::evaluate(const std::string &expression) //throw(ParserException)
 	{
 		Parser tmpParser;
@@ -62,11 +228,13 @@ namespace orchestracpp
 	ExpressionNode *Parser::parse(const std::string &expression)// throw(ParserException) 
 	{		
 		ParserStringTokenizer tokenizer(StringHelper::trim(expression));
+		parsing = true;
 		ExpressionNode *node = parseSum(&tokenizer);
+		parsing = false;
 
 		if (tokenizer.hasMoreTokens())
 		{
-            std::string tmp =   "Found a redundant:   " + tokenizer.nextToken() + "   in the expression: " + expression;
+            std::string tmp =   "Found a redundant:   " + std::string(tokenizer.nextToken()) + "   in the expression: " + expression;
 			throw OrchestraException(tmp);		
 		}
 
@@ -88,11 +256,45 @@ namespace orchestracpp
 		// each new result variable gets a memory node
 		// this memory node may be removed during optimization when this variable is only used once.
 
-		resultVariable->memory = new MemoryNode(parse(expression->getExpression()));
+		resultVariable->memory = new (this) MemoryNode(parse(expression->getExpression()));
 		newNode(resultVariable->memory); // register this node for deletion
 
 	}
 
+	void Parser::addVector(const std::string& name, const std::vector<std::string>& elements)
+	{
+		if (elements.empty())
+		{
+			throw ParserException("The vector " + name + " has no elements");
+		}
+		for (auto& element : elements)
+		{
+			if (variables->get(element) == nullptr)
+			{
+				throw ReadException("@vector: " + name + " could not find variable " + element);
+			}
+		}
+		vectors[name] = elements;
+	}
+
+	void Parser::addTable(const std::string& name, const std::vector<std::string>& numbers)
+	{
+		if (numbers.empty())
+		{
+			throw ParserException("The table " + name + " has no numbers");
+		}
+		for (auto& number : numbers)
+		{
+			double value;
+			auto result = std::from_chars(number.data(), number.data() + number.length(), value);
+			if ((result.ec != std::errc()) || (result.ptr != number.data() + number.length()))
+			{
+				throw ParserException("Not a valid number: " + number + " in table " + name);
+			}
+		}
+		tables[name] = numbers;
+	}
+
 	ExpressionNode *Parser::parseSum(ParserStringTokenizer *stream) //throw(ParserException)
 	{
 		ExpressionNode *anchor = parseTerm(stream);
@@ -101,12 +303,12 @@ namespace orchestracpp
 			if (stream->match("+"))
 			{
 				stream->consume();
-				anchor = newNode(new PlusNode(anchor, parseTerm(stream)));
+				anchor = newNode(new (this) PlusNode(anchor, parseTerm(stream)));
 			}
 			else
 			{
 				stream->consume();
-				anchor = newNode(new MinusNode(anchor, parseTerm(stream)));
+				anchor = newNode(new (this) MinusNode(anchor, parseTerm(stream)));
 			}
 		}
 
@@ -122,12 +324,12 @@ namespace orchestracpp
 			if (stream->match("*"))
 			{
 				stream->consume();
-				anchor = newNode(new TimesNode(anchor, parseExponent(stream)));
+				anchor = newNode(new (this) TimesNode(anchor, parseExponent(stream)));
 			}
 			else
 			{
 				stream->consume();
-				anchor = newNode(new DivideNode(anchor, parseExponent(stream)));
+				anchor = newNode(new (this) DivideNode(anchor, parseExponent(stream)));
 			}
 		}
 		return anchor;
@@ -140,7 +342,7 @@ namespace orchestracpp
 		while (stream->hasMoreTokens() && stream->match("^"))
 		{
 			stream->consume();
-			anchor = newNode(new PowerNode(anchor, parseElement(stream)));
+			anchor = newNode(new (this) PowerNode(anchor, parseElement(stream)));
 		}
 
 		return anchor;
@@ -170,7 +372,7 @@ namespace orchestracpp
 		else if (stream->match("-"))
 		{
 			stream->consume();
-			return (newNode(new UMinNode(parseElement(stream))));
+			return (newNode(new (this) UMinNode(parseElement(stream))));
 		}
 		else if (stream->isNumber())
 		{
@@ -181,67 +383,67 @@ namespace orchestracpp
 		else if (stream->equals("sqrt"))
 		{
 			stream->consume();
-			return newNode(new SqrtNode(parseElement(stream)));
+			return newNode(new (this) SqrtNode(parseElement(stream)));
 		}
 		else if (stream->equals("log"))
 		{
 			stream->consume();
-			return newNode(new LogNode(parseElement(stream)));
+			return newNode(new (this) LogNode(parseElement(stream)));
 		}
 		else if (stream->equals("abs"))
 		{
 			stream->consume();
-			return newNode(new AbsNode(parseElement(stream)));
+			return newNode(new (this) AbsNode(parseElement(stream)));
 		}
 		else if (stream->equals("log10"))
 		{
 			stream->consume();
-			return newNode(new Log10Node(parseElement(stream)));
+			return newNode(new (this) Log10Node(parseElement(stream)));
 		}
 		else if (stream->equals("exp"))
 		{
 			stream->consume();
-			return newNode(new ExpNode(parseElement(stream)));
+			return newNode(new (this) ExpNode(parseElement(stream)));
 		}
 		else if (stream->equals("sin"))
 		{
 			stream->consume();
-			return newNode(new SinNode(parseElement(stream)));
+			return newNode(new (this) SinNode(parseElement(stream)));
 		}
 		else if (stream->equals("cos"))
 		{
 			stream->consume();
-			return newNode(new CosNode(parseElement(stream)));
+			return newNode(new (this) CosNode(parseElement(stream)));
 		}
 		else if (stream->equals("tan"))
 		{
 			stream->consume();
-			return newNode(new TanNode(parseElement(stream)));
+			return newNode(new (this) TanNode(parseElement(stream)));
 		}
 		else if (stream->equals("sinh"))
 		{
 			stream->consume();
-			return newNode(new SinhNode(parseElement(stream)));
+			return newNode(new (this) SinhNode(parseElement(stream)));
 		}
 		else if (stream->equals("cosh"))
 		{
 			stream->consume();
-			return newNode(new CoshNode(parseElement(stream)));
+			return newNode(new (this) CoshNode(parseElement(stream)));
 		}
 		else if (stream->equals("tanh"))
 		{
 			stream->consume();
-			return newNode(new TanhNode(parseElement(stream)));
+			return newNode(new (this) TanhNode(parseElement(stream)));
 		}
 		else if (stream->equals("atan"))
 		{
 			stream->consume();
-			return newNode(new ATanNode(parseElement(stream)));
+			return newNode(new (this) ATanNode(parseElement(stream)));
 		}
 		else if (stream->equals("print"))
 		{
 			stream->consume();
-			return newNode(new PrintNode(parseElement(stream)));
+			return newNode(new (this) PrintNode(parseElement(stream)));
 		}
 		else if (stream->equals("if"))
 		{
@@ -253,7 +455,7 @@ namespace orchestracpp
 			stream->matchAndConsume(",");
 			ExpressionNode *e2 = parseSum(stream);
 			stream->matchAndConsume(")");
-			return newNode(new IfNode(condition, e1, e2));
+			return newNode(new (this) IfNode(condition, e1, e2));
 		}
 		else if (stream->equals("max"))
 		{
@@ -263,7 +465,7 @@ namespace orchestracpp
 			stream->matchAndConsume(",");
 			ExpressionNode *e2 = parseSum(stream);
 			stream->matchAndConsume(")");
-			return newNode(new MaxNode(e1, e2));
+			return newNode(new (this) MaxNode(e1, e2));
 		}
 		else if (stream->equals("min"))
 		{
@@ -273,7 +475,52 @@ namespace orchestracpp
 			stream->matchAndConsume(",");
 			ExpressionNode *e2 = parseSum(stream);
 			stream->matchAndConsume(")");
-			return newNode(new MinimumNode(e1, e2));
+			return newNode(new (this) MinimumNode(e1, e2));
+		}
+		else if (stream->equals("sum") && (stream->isVariable(variables) == nullptr))
+		{
+			stream->consume();
+			stream->matchAndConsume("(");
+			std::vector<ExpressionNode*> elements;
+			parseElements(stream, elements);
+			stream->matchAndConsume(")");
+
+			ExpressionNode *anchor = nullptr;
+			for (auto element : elements)
+			{
+				if (element != nullptr)
+				{
+					anchor = (anchor == nullptr) ? element : newNode(new (this) PlusNode(anchor, element));
+				}
+			}
+			return (anchor == nullptr) ? NumberNode::createNumberNode(0.0, this) : anchor;
+		}
+		else if (stream->equals("dot") && (stream->isVariable(variables) == nullptr))
+		{
+			stream->consume();
+			stream->matchAndConsume("(");
+			std::vector<ExpressionNode*> e1;
+			parseElements(stream, e1);
+			stream->matchAndConsume(",");
+			std::vector<ExpressionNode*> e2;
+			parseElements(stream, e2);
+			stream->matchAndConsume(")");
+
+			if (e1.size() != e2.size())
+			{
+				throw ParserException("dot() of vectors with different lengths in expression: " + stream->getExpression());
+			}
+
+			ExpressionNode *anchor = nullptr;
+			for (size_t i = 0; i < e1.size(); i++)
+			{
+				if ((e1[i] != nullptr) && (e2[i] != nullptr))
+				{
+					ExpressionNode *term = newNode(new (this) TimesNode(e1[i], e2[i]));
+					anchor = (anchor == nullptr) ? term : newNode(new (this) PlusNode(anchor, term));
+				}
+			}
+			return (anchor == nullptr) ? NumberNode::createNumberNode(0.0, this) : anchor;
 		}
 
 
@@ -283,21 +530,55 @@ namespace orchestracpp
 		if (variable != nullptr)
 		{
 			stream->consume();
+			return variableNode(variable);
+		}
+		
+		throw ParserException("Variable or number expected but found: '" + std::string(stream->getCurrentToken()) + "'     In expression: " +stream->getExpression());
+	}
+
+	ExpressionNode *Parser::variableNode(Var *variable)
+	{
+		if (variable->memory == nullptr)
+		{
+			// a variable gets an attached memory node if it is used as intermediate result.
+			// If not, simply return the variable
+			return variable;
+		}
+		else
+		{
+			variable->memory->nrReferences++;
+			return variable->memory;
+		}
+	}
 
-			if (variable->memory == nullptr)
+	void Parser::parseElements(ParserStringTokenizer *stream, std::vector<ExpressionNode*>& elements)// throw(ParserException)
+	{
+		std::string name(stream->nextToken());
+
+		auto vector = vectors.find(name);
+		if (vector != vectors.end())
+		{
+			stream->consume();
+			for (auto& element : vector->second)
 			{
-				// a variable gets an attached memory node if it is used as intermediate result.
-				// If not, simply return the variable
-				return variable;
+				elements.push_back(variableNode(variables->get(element)));
 			}
-			else
+			return;
+		}
+
+		auto table = tables.find(name);
+		if (table != tables.end())
+		{
+			stream->consume();
+			for (auto& number : table->second)
 			{
-				variable->memory->nrReferences++;
-				return variable->memory;
+				NumberNode *constant = NumberNode::createNumberNode(number, this);
+				elements.push_back((constant->evaluate() == 0) ? nullptr : constant);
 			}
+			return;
 		}
-		
-		throw ParserException("Variable or number expected but found: '" + stream->getCurrentToken() + "'     In expression: " +stream->getExpression());
+
+		throw ParserException("Vector or table expected but found: '" + name + "'     In expression: " + stream->getExpression());
 	}
 
 	BExpressionNode *Parser::parseBElement(ParserStringTokenizer *stream)// throw(ParserException)
@@ -370,37 +651,58 @@ namespace orchestracpp
 //    std::map<std::string, NumberNode*> NumberNode::constants;
 	//std::map<std::string, NumberNode*> Parser::constants;
 
-	NumberNode *NumberNode::createNumberNode(const std::string &nameIn, Parser* parser)
+	/* Round a value to a number of significant digits, exactly as printing it with
+	 * this precision (std::setprecision, %g) and reading it back would do.
+	 */
+	static double roundToDigits(double value, int digits)
 	{
-		NumberNode *tmpNode;
-		/* convert string to double and back to assure standard format of string (1.0 1 1.000) */
-		double tmpNumber = std::stod(nameIn);
-        // convert double to string
-	    // be careful: standard C++ dtos has too low precision!
-		std::string name = StringHelper::doubleToString(tmpNumber, 14);
-	
-		if (parser->constants.find(name) != parser->constants.end())
-		{ //  this constant already exists,
-			tmpNode = parser->constants[name];
-		}
-		else
-		{ // does not exist, create new one and add to constants
-			tmpNode = new NumberNode(name,parser);
-			parser->newNode(tmpNode); // register as expression node for deletion
-			parser->constants.emplace(name, tmpNode);
-			//std::cout << std::setprecision(12) << nameIn << " " << tmpNumber << " " << name << std::endl;
+		char buffer[64];
+		auto printed = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, digits);
+		double result = value;
+		std::from_chars(buffer, printed.ptr, result);
+		return result;
+	}
 
+	NumberNode *NumberNode::createNumberNode(std::string_view nameIn, Parser* parser)
+	{
+		double tmpNumber = 0;
+		auto result = std::from_chars(nameIn.data(), nameIn.data() + nameIn.length(), tmpNumber);
+		if (result.ec != std::errc())
+		{
+			throw ParserException("Not a valid number: " + std::string(nameIn));
 		}
-		return tmpNode;
+		/* round to 14 digits, so 1.0 1 1.000 give the same constant */
+		return internNumberNode(roundToDigits(tmpNumber, 14), parser);
 	}
 
 	NumberNode *NumberNode::createNumberNode(double value, Parser* parser)
 	{
-		// be careful: standard C++ dtos has too low accuracy!
-		return createNumberNode(StringHelper::doubleToString(value, 12), parser);
+		// folded constants are rounded to 12 digits
+		return internNumberNode(roundToDigits(value, 12), parser);
+	}
+
+	NumberNode *NumberNode::createExactNumberNode(double value, Parser* parser)
+	{
+		return internNumberNode(value, parser);
+	}
+
+	NumberNode *NumberNode::internNumberNode(double value, Parser* parser)
+	{
+		uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+
+		auto found = parser->constants.find(bits);
+		if (found != parser->constants.end())
+		{ //  this constant already exists,
+			return found->second;
+		}
+		NumberNode *tmpNode = new (parser) NumberNode(value);
+		parser->newNode(tmpNode); // register as expression node for deletion
+		parser->constants.emplace(bits, tmpNode);
+		return tmpNode;
 	}
 
-	NumberNode::NumberNode(const std::string &name, Parser* parser) : value(std::stod(name))
+	NumberNode::NumberNode(double value) : value(value)
 	{
 	}
 
@@ -409,6 +711,20 @@ namespace orchestracpp
 		return value;
 	}
 
+	int NumberNode::compile(ExpressionProgram* program)
+	{
+		return program->addConstant(value);
+	}
+
+	void NumberNode::getChildren(std::vector<ExpressionNode**>& /*children*/)
+	{
+	}
+
+	ExpressionNode* NumberNode::copy(Parser* parser)
+	{
+		return new (parser) NumberNode(*this);
+	}
+
 	void NumberNode::setDependentMemoryNode(MemoryNode *parent)
 	{
 	}
@@ -438,6 +754,26 @@ namespace orchestracpp
 		return std::abs(child->evaluate());
 	}
 
+	int AbsNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::ABS, program->compile(child));
+	}
+
+	void AbsNode::getChildren(std::vector<ExpressionNode**>& children)
+	{
+		children.push_back(&child);
+	}
+
+	ExpressionNode* AbsNode::copy(Parser* parser)
+	{
+		return new (parser) AbsNode(*this);
+	}
+
+	std::string AbsNode::structuralKey()
+	{
+		return nodeKey("abs", child);
+	}
+
 	bool AbsNode::constant()
 	{
 		return child->constant();
@@ -474,6 +810,26 @@ namespace orchestracpp
 		return -(child->evaluate());
 	}
 
+	int UMinNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::UMIN, program->compile(child));
+	}
+
+	void UMinNode::getChildren(std::vector<ExpressionNode**>& children)
+	{
+		children.push_back(&child);
+	}
+
+	ExpressionNode* UMinNode::copy(Parser* parser)
+	{
+		return new (parser) UMinNode(*this);
+	}
+
+	std::string UMinNode::structuralKey()
+	{
+		return nodeKey("-", child);
+	}
+
 	bool UMinNode::constant()
 	{
 		return child->constant();
@@ -509,6 +865,28 @@ namespace orchestracpp
 		return left->evaluate() + right->evaluate();
 	}
 
+	int PlusNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::PLUS, program->compile(left), program->compile(right));
+	}
+
+	void PlusNode::getChildren(std::vector<ExpressionNode**>& children)
+	{
+		children.push_back(&left);
+		children.push_back(&right);
+	}
+
+	ExpressionNode* PlusNode::copy(Parser* parser)
+	{
+		return new (parser) PlusNode(*this);
+	}
+
+	std::string PlusNode::structuralKey()
+	{
+		// a + b == b + a, so the children are ordered
+		return nodeKey("+", std::min(left, right), std::max(left, right));
+	}
+
 	void PlusNode::setDependentMemoryNode(MemoryNode *parent)
 	{
 		left->setDependentMemoryNode(parent);
@@ -688,7 +1066,29 @@ namespace orchestracpp
 		return value;
 	}
 
+	int MultiPlusNode::compile(ExpressionProgram* program)
+	{
+		return program->addMultiPlus(nrChildren, childRefs, factors);
+	}
+
+	void MultiPlusNode::getChildren(std::vector<ExpressionNode**>& children)
+	{
+		for (int n = 0; n < nrChildren; n++) {
+			children.push_back(&childRefs[n]);
+		}
+	}
+
+	ExpressionNode* MultiPlusNode::copy(Parser* parser)
+	{
+		MultiPlusNode* tmp = new (parser) MultiPlusNode(*this);
+		tmp->originalPlusNode = nullptr; // this one is not kept
+		return tmp;
+	}
+
 	void MultiPlusNode::setDependentMemoryNode(MemoryNode* parent) {
+		for (int n = 0; n < nrChildren; n++) {
+			childRefs[n]->setDependentMemoryNode(parent);
+		}
 	}
 
 	bool MultiPlusNode::constant() {
@@ -699,6 +1099,100 @@ namespace orchestracpp
 		return this;
 	}
 
+	MultiTimesNode::MultiTimesNode(const std::vector<ExpressionNode*>& children) {
+		nrChildren = (int)children.size();
+		childRefs = new ExpressionNode * [nrChildren];
+		for (int n = 0; n < nrChildren; n++) {
+			childRefs[n] = children[n];
+		}
+	}
+
+	double MultiTimesNode::evaluate() {
+		double value = childRefs[0]->evaluate();
+		for (int n = 1; n < nrChildren; n++) {
+			value = value * childRefs[n]->evaluate();
+		}
+		return value;
+	}
+
+	int MultiTimesNode::compile(ExpressionProgram* program)
+	{
+		return program->addMultiTimes(nrChildren, childRefs);
+	}
+
+	void MultiTimesNode::getChildren(std::vector<ExpressionNode**>& children)
+	{
+		for (int n = 0; n < nrChildren; n++) {
+			children.push_back(&childRefs[n]);
+		}
+	}
+
+	ExpressionNode* MultiTimesNode::copy(Parser* parser)
+	{
+		std::vector<ExpressionNode*> children(childRefs, childRefs + nrChildren);
+		return new (parser) MultiTimesNode(children);
+	}
+
+	void MultiTimesNode::setDependentMemoryNode(MemoryNode* parent) {
+		for (int n = 0; n < nrChildren; n++) {
+			childRefs[n]->setDependentMemoryNode(parent);
+		}
+	}
+
+	bool MultiTimesNode::constant() {
+		for (int n = 0; n < nrChildren; n++) {
+			if (!childRefs[n]->constant()) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	ExpressionNode* MultiTimesNode::optimize(Parser* parser) {
+		if (isoptimized) {
+			return this;
+		}
+		isoptimized = true;
+		for (int n = 0; n < nrChildren; n++) {
+			childRefs[n] = childRefs[n]->optimize(parser);
+		}
+		return this;
+	}
+
+	void MultiTimesNode::getFactors(std::vector<ExpressionNode*>& factors) {
+		for (int n = 0; n < nrChildren; n++) {
+			factors.push_back(childRefs[n]);
+		}
+	}
+
+	/* Replaces the 10^x factors of a product by a single 10^(sum of x).
+	*  Only nodes without other parents are combined (shared ones sit behind a memory node),
+	*  otherwise the original powers still have to be evaluated and nothing is gained.
+	*/
+	static void combinePowersOf10(std::vector<ExpressionNode*>& factors, Parser* parser)
+	{
+		std::vector<ExpressionNode*> otherFactors;
+		ExpressionNode* exponent = nullptr;
+		int nrPowers = 0;
+
+		for (auto factor : factors) {
+			if (typeid(*factor) == typeid(Power10Node)) {
+				ExpressionNode* x = ((Power10Node*)factor)->right;
+				exponent = (exponent == nullptr) ? x : parser->newNode(new (parser) PlusNode(exponent, x));
+				nrPowers++;
+			}
+			else {
+				otherFactors.push_back(factor);
+			}
+		}
+
+		if (nrPowers >= 2) {
+			parser->nrRewrites++;
+			otherFactors.push_back(parser->newNode(new (parser) Power10Node(exponent))->optimize(parser));
+			factors = otherFactors;
+		}
+	}
+
 
 
 	MinusNode::MinusNode(ExpressionNode *left, ExpressionNode *right)
@@ -712,6 +1206,27 @@ namespace orchestracpp
 		return left->evaluate() - right->evaluate();
 	}
 
+	int MinusNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::MINUS, program->compile(left), program->compile(right));
+	}
+
+	void MinusNode::getChildren(std::vector<ExpressionNode**>& children)
+	{
+		children.push_back(&left);
+		children.push_back(&right);
+	}
+
+	ExpressionNode* MinusNode::copy(Parser* parser)
+	{
+		return new (parser) MinusNode(*this);
+	}
+
+	std::string MinusNode::structuralKey()
+	{
+		return nodeKey("-", left, right);
+	}
+
 	void MinusNode::setDependentMemoryNode(MemoryNode *parent)
 	{
 		left->setDependentMemoryNode(parent);
@@ -751,7 +1266,7 @@ namespace orchestracpp
 		{
 			if (left->evaluate() == 0.0)
 			{
-				ExpressionNode * tmpNode = new UMinNode(right);
+				ExpressionNode * tmpNode = new (parser) UMinNode(right);
 				return tmpNode->optimize(parser);
 			}
 		}
@@ -759,15 +1274,37 @@ namespace orchestracpp
 		return this;
 	}
 
-	TimesNode::TimesNode(ExpressionNode *left, ExpressionNode *right)
+	TimesNode::TimesNode(ExpressionNode *left, ExpressionNode *right)
+	{
+		this->left = left;
+		this->right = right;
+	}
+
+	double TimesNode::evaluate()
+	{
+		return left->evaluate() * right->evaluate();
+	}
+
+	int TimesNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::TIMES, program->compile(left), program->compile(right));
+	}
+
+	void TimesNode::getChildren(std::vector<ExpressionNode**>& children)
+	{
+		children.push_back(&left);
+		children.push_back(&right);
+	}
+
+	ExpressionNode* TimesNode::copy(Parser* parser)
 	{
-		this->left = left;
-		this->right = right;
+		return new (parser) TimesNode(*this);
 	}
 
-	double TimesNode::evaluate()
+	std::string TimesNode::structuralKey()
 	{
-		return left->evaluate() * right->evaluate();
+		// a * b == b * a, so the children are ordered
+		return nodeKey("*", std::min(left, right), std::max(left, right));
 	}
 
 	void TimesNode::setDependentMemoryNode(MemoryNode *parent)
@@ -828,7 +1365,40 @@ namespace orchestracpp
 
 		}
 
-		return this;
+		// Flatten left nested products into a single MultiTimesNode.
+		// The factors are multiplied in the same order, so the result does not change.
+		std::vector<ExpressionNode*> factors;
+		if (typeid(*left) == typeid(TimesNode))
+		{
+			factors.push_back(((TimesNode*)left)->left);
+			factors.push_back(((TimesNode*)left)->right);
+		}
+		else if (typeid(*left) == typeid(MultiTimesNode))
+		{
+			((MultiTimesNode*)left)->getFactors(factors);
+		}
+		else
+		{
+			factors.push_back(left);
+		}
+		factors.push_back(right);
+
+		if (parser->algebraicRewrites)
+		{
+			combinePowersOf10(factors, parser);
+		}
+
+		if (factors.size() == 1)
+		{
+			return factors[0];
+		}
+		if (factors.size() == 2)
+		{
+			left = factors[0];
+			right = factors[1];
+			return this;
+		}
+		return parser->newNode(new (parser) MultiTimesNode(factors));
 	}
 
 	DivideNode::DivideNode(ExpressionNode *left, ExpressionNode *right)
@@ -842,6 +1412,27 @@ namespace orchestracpp
 		return left->evaluate() / right->evaluate();
 	}
 
+	int DivideNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::DIVIDE, program->compile(left), program->compile(right));
+	}
+
+	void DivideNode::getChildren(std::vector<ExpressionNode**>& children)
+	{
+		children.push_back(&left);
+		children.push_back(&right);
+	}
+
+	ExpressionNode* DivideNode::copy(Parser* parser)
+	{
+		return new (parser) DivideNode(*this);
+	}
+
+	std::string DivideNode::structuralKey()
+	{
+		return nodeKey("/", left, right);
+	}
+
 	bool DivideNode::constant()
 	{
 		return (left->constant() && right->constant());
@@ -879,6 +1470,18 @@ namespace orchestracpp
 			return left;
 		}
 
+		// a multiplication is much faster than a division
+		if (parser->algebraicRewrites && right->constant())
+		{
+			double reciprocal = 1.0 / right->evaluate();
+			if (std::isfinite(reciprocal) && (reciprocal != 0.0))
+			{
+				parser->nrRewrites++;
+				ExpressionNode * tempNode = parser->newNode(new (parser) TimesNode(left, NumberNode::createExactNumberNode(reciprocal, parser)));
+				return tempNode->optimize(parser);
+			}
+		}
+
 		return this;
 	}
 
@@ -903,6 +1506,27 @@ namespace orchestracpp
 		}
 	}
 
+	int MaxNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::MAX, program->compile(left), program->compile(right));
+	}
+
+	void MaxNode::getChildren(std::vector<ExpressionNode**>& children)
+	{
+		children.push_back(&left);
+		children.push_back(&right);
+	}
+
+	ExpressionNode* MaxNode::copy(Parser* parser)
+	{
+		return new (parser) MaxNode(*this);
+	}
+
+	std::string MaxNode::structuralKey()
+	{
+		return nodeKey("max", left, right);
+	}
+
 	bool MaxNode::constant()
 	{
 		return (left->constant() && right->constant());
@@ -954,6 +1578,27 @@ namespace orchestracpp
 		}
 	}
 
+	int MinimumNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::MIN, program->compile(left), program->compile(right));
+	}
+
+	void MinimumNode::getChildren(std::vector<ExpressionNode**>& children)
+	{
+		children.push_back(&left);
+		children.push_back(&right);
+	}
+
+	ExpressionNode* MinimumNode::copy(Parser* parser)
+	{
+		return new (parser) MinimumNode(*this);
+	}
+
+	std::string MinimumNode::structuralKey()
+	{
+		return nodeKey("min", left, right);
+	}
+
 	bool MinimumNode::constant()
 	{
 		return (left->constant() && right->constant());
@@ -999,6 +1644,27 @@ namespace orchestracpp
 		return std::pow(left->evaluate(), right->evaluate());
 	}
 
+	int PowerNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::POWER, program->compile(left), program->compile(right));
+	}
+
+	void PowerNode::getChildren(std::vector<ExpressionNode**>& children)
+	{
+		children.push_back(&left);
+		children.push_back(&right);
+	}
+
+	ExpressionNode* PowerNode::copy(Parser* parser)
+	{
+		return new (parser) PowerNode(*this);
+	}
+
+	std::string PowerNode::structuralKey()
+	{
+		return nodeKey("^", left, right);
+	}
+
 	void PowerNode::setDependentMemoryNode(MemoryNode *parent)
 	{
 		left->setDependentMemoryNode(parent);
@@ -1042,7 +1708,7 @@ namespace orchestracpp
 			}
 			if (leftvalue == 10.0)
 			{
-				ExpressionNode * tempNode = parser->newNode(new Power10Node(right));
+				ExpressionNode * tempNode = parser->newNode(new (parser) Power10Node(right));
 				return tempNode->optimize(parser);
 			}
 		}
@@ -1066,12 +1732,33 @@ namespace orchestracpp
 
 			if (rightvalue == 2.0)
 			{
-				return parser->newNode(new SqrNode(left));
+				return parser->newNode(new (parser) SqrNode(left));
+			}
+
+			if (rightvalue == 0.5)
+			{
+				return parser->newNode(new (parser) SqrtNode(left));
+			}
+
+			if ((rightvalue == 3.0) && parser->algebraicRewrites)
+			{
+				// x*x*x, with x behind a memory node so it is evaluated only once
+				ExpressionNode* x = left;
+				if ((dynamic_cast<Var*>(x) == nullptr) && (typeid(*x) != typeid(MemoryNode)))
+				{
+					MemoryNode* memory = new (parser) MemoryNode(x);
+					memory->nrReferences = 3;
+					memory->isoptimized = true;
+					x = parser->newNode(memory);
+				}
+				parser->nrRewrites++;
+				ExpressionNode * tempNode = parser->newNode(new (parser) TimesNode(parser->newNode(new (parser) TimesNode(x, x)), x));
+				return tempNode->optimize(parser);
 			}
 
 			if (rightvalue == -1.0)
 			{
-				ExpressionNode * tempNode = parser->newNode(new DivideNode(NumberNode::createNumberNode(1.0, parser), left));
+				ExpressionNode * tempNode = parser->newNode(new (parser) DivideNode(NumberNode::createNumberNode(1.0, parser), left));
 				return tempNode->optimize(parser);
 			}
 
@@ -1087,9 +1774,33 @@ namespace orchestracpp
 
 	double Power10Node::evaluate()
 	{
+		if (fastMath)
+		{
+			return FastMath::exp10(right->evaluate());
+		}
 		return std::pow(10, right->evaluate());
 	}
 
+	int Power10Node::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(fastMath ? ExpressionProgram::FAST_POWER10 : ExpressionProgram::POWER10, program->compile(right));
+	}
+
+	void Power10Node::getChildren(std::vector<ExpressionNode**>& children)
+	{
+		children.push_back(&right);
+	}
+
+	ExpressionNode* Power10Node::copy(Parser* parser)
+	{
+		return new (parser) Power10Node(*this);
+	}
+
+	std::string Power10Node::structuralKey()
+	{
+		return nodeKey("10^", right);
+	}
+
 	void Power10Node::setDependentMemoryNode(MemoryNode *parent)
 	{
 		right->setDependentMemoryNode(parent);
@@ -1107,6 +1818,7 @@ namespace orchestracpp
 			return this;
 		}
 		isoptimized = true;
+		fastMath = parser->fastMath;
 
 		right = right->optimize(parser);
 
@@ -1138,6 +1850,29 @@ namespace orchestracpp
 		}
 	}
 
+	int IfNode::compile(ExpressionProgram* program)
+	{
+		// both branches are evaluated, the condition selects the result
+		return program->addInstruction(ExpressionProgram::SELECT, program->compile(condition), program->compile(left), program->compile(right));
+	}
+
+	void IfNode::getChildren(std::vector<ExpressionNode**>& children)
+	{
+		condition->getChildren(children);
+		children.push_back(&left);
+		children.push_back(&right);
+	}
+
+	ExpressionNode* IfNode::copy(Parser* parser)
+	{
+		return new (parser) IfNode(*this);
+	}
+
+	std::string IfNode::structuralKey()
+	{
+		return nodeKey("if", condition, left, right);
+	}
+
 	void IfNode::setDependentMemoryNode(MemoryNode *parent)
 	{
 		if (std::find(dependentChildren.begin(), dependentChildren.end(), parent) != dependentChildren.end())
@@ -1239,13 +1974,35 @@ namespace orchestracpp
 		return this;
 	}
 
+	std::string Function1Node::structuralKey()
+	{
+		return nodeKey(typeid(*this).name(), child);
+	}
+
+	void Function1Node::getChildren(std::vector<ExpressionNode**>& children)
+	{
+		children.push_back(&child);
+	}
+
 	SqrNode::SqrNode(ExpressionNode* child) : Function1Node(child)
 	{
 	}
 
 	double SqrNode::evaluate()
 	{
-		return std::pow(child->evaluate(),2);
+		// the same result as std::pow(x, 2), but much faster
+		double x = child->evaluate();
+		return x * x;
+	}
+
+	int SqrNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::SQR, program->compile(child));
+	}
+
+	ExpressionNode* SqrNode::copy(Parser* parser)
+	{
+		return new (parser) SqrNode(*this);
 	}
 
 	SqrtNode::SqrtNode(ExpressionNode *child) : Function1Node(child)
@@ -1257,33 +2014,137 @@ namespace orchestracpp
 		return std::sqrt(child->evaluate());
 	}
 
+	int SqrtNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::SQRT, program->compile(child));
+	}
+
+	ExpressionNode* SqrtNode::copy(Parser* parser)
+	{
+		return new (parser) SqrtNode(*this);
+	}
+
 	LogNode::LogNode(ExpressionNode *child) : Function1Node(child)
 	{
 	}
 
 	double LogNode::evaluate()
 	{
+		if (fastMath)
+		{
+			return FastMath::log(child->evaluate());
+		}
 		return std::log(child->evaluate());
 	}
 
+	int LogNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(fastMath ? ExpressionProgram::FAST_LOG : ExpressionProgram::LOG, program->compile(child));
+	}
+
+	ExpressionNode* LogNode::copy(Parser* parser)
+	{
+		return new (parser) LogNode(*this);
+	}
+
+	ExpressionNode *LogNode::optimize(Parser* parser)
+	{
+		fastMath = parser->fastMath;
+		ExpressionNode* result = Function1Node::optimize(parser);
+		if ((result != this) || !parser->algebraicRewrites)
+		{
+			return result;
+		}
+
+		// log(exp(x)) = x, also if the inner node is shared
+		ExpressionNode* inner = child;
+		if (typeid(*inner) == typeid(MemoryNode))
+		{
+			inner = ((MemoryNode*)inner)->child;
+		}
+		if (typeid(*inner) == typeid(ExpNode))
+		{
+			parser->nrRewrites++;
+			return ((ExpNode*)inner)->child;
+		}
+		return this;
+	}
+
 	Log10Node::Log10Node(ExpressionNode *child) : Function1Node(child)
 	{
 	}
 
 	double Log10Node::evaluate()
 	{
+		if (fastMath)
+		{
+			return FastMath::log10(child->evaluate());
+		}
 		return std::log10(child->evaluate());
 	}
 
+	int Log10Node::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(fastMath ? ExpressionProgram::FAST_LOG10 : ExpressionProgram::LOG10, program->compile(child));
+	}
+
+	ExpressionNode* Log10Node::copy(Parser* parser)
+	{
+		return new (parser) Log10Node(*this);
+	}
+
+	ExpressionNode *Log10Node::optimize(Parser* parser)
+	{
+		fastMath = parser->fastMath;
+		ExpressionNode* result = Function1Node::optimize(parser);
+		if ((result != this) || !parser->algebraicRewrites)
+		{
+			return result;
+		}
+
+		// log10(10^x) = x, also if the inner node is shared
+		ExpressionNode* inner = child;
+		if (typeid(*inner) == typeid(MemoryNode))
+		{
+			inner = ((MemoryNode*)inner)->child;
+		}
+		if (typeid(*inner) == typeid(Power10Node))
+		{
+			parser->nrRewrites++;
+			return ((Power10Node*)inner)->right;
+		}
+		return this;
+	}
+
 	ExpNode::ExpNode(ExpressionNode *child) : Function1Node(child)
 	{
 	}
 
 	double ExpNode::evaluate()
 	{
+		if (fastMath)
+		{
+			return FastMath::exp(child->evaluate());
+		}
 		return std::exp(child->evaluate());
 	}
 
+	int ExpNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(fastMath ? ExpressionProgram::FAST_EXP : ExpressionProgram::EXP, program->compile(child));
+	}
+
+	ExpressionNode* ExpNode::copy(Parser* parser)
+	{
+		return new (parser) ExpNode(*this);
+	}
+
+	ExpressionNode *ExpNode::optimize(Parser* parser)
+	{
+		fastMath = parser->fastMath;
+		return Function1Node::optimize(parser);
+	}
+
 	SinNode::SinNode(ExpressionNode *child) : Function1Node(child)
 	{
 	}
@@ -1293,6 +2154,16 @@ namespace orchestracpp
 		return std::sin(child->evaluate());
 	}
 
+	int SinNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::SIN, program->compile(child));
+	}
+
+	ExpressionNode* SinNode::copy(Parser* parser)
+	{
+		return new (parser) SinNode(*this);
+	}
+
 	CosNode::CosNode(ExpressionNode *child) : Function1Node(child)
 	{
 	}
@@ -1302,6 +2173,16 @@ namespace orchestracpp
 		return std::cos(child->evaluate());
 	}
 
+	int CosNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::COS, program->compile(child));
+	}
+
+	ExpressionNode* CosNode::copy(Parser* parser)
+	{
+		return new (parser) CosNode(*this);
+	}
+
 	TanNode::TanNode(ExpressionNode *child) : Function1Node(child)
 	{
 	}
@@ -1311,6 +2192,16 @@ namespace orchestracpp
 		return std::tan(child->evaluate());
 	}
 
+	int TanNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::TAN, program->compile(child));
+	}
+
+	ExpressionNode* TanNode::copy(Parser* parser)
+	{
+		return new (parser) TanNode(*this);
+	}
+
 	SinhNode::SinhNode(ExpressionNode *child) : Function1Node(child)
 	{
 	}
@@ -1320,6 +2211,16 @@ namespace orchestracpp
 		return std::sinh(child->evaluate());
 	}
 
+	int SinhNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::SINH, program->compile(child));
+	}
+
+	ExpressionNode* SinhNode::copy(Parser* parser)
+	{
+		return new (parser) SinhNode(*this);
+	}
+
 	CoshNode::CoshNode(ExpressionNode *child) : Function1Node(child)
 	{
 	}
@@ -1329,6 +2230,16 @@ namespace orchestracpp
 		return std::cosh(child->evaluate());
 	}
 
+	int CoshNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::COSH, program->compile(child));
+	}
+
+	ExpressionNode* CoshNode::copy(Parser* parser)
+	{
+		return new (parser) CoshNode(*this);
+	}
+
 	TanhNode::TanhNode(ExpressionNode *child) : Function1Node(child)
 	{
 	}
@@ -1338,6 +2249,16 @@ namespace orchestracpp
 		return std::tanh(child->evaluate());
 	}
 
+	int TanhNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::TANH, program->compile(child));
+	}
+
+	ExpressionNode* TanhNode::copy(Parser* parser)
+	{
+		return new (parser) TanhNode(*this);
+	}
+
 	ATanNode::ATanNode(ExpressionNode *child) : Function1Node(child)
 	{
 	}
@@ -1347,6 +2268,16 @@ namespace orchestracpp
 		return std::atan(child->evaluate());
 	}
 
+	int ATanNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::ATAN, program->compile(child));
+	}
+
+	ExpressionNode* ATanNode::copy(Parser* parser)
+	{
+		return new (parser) ATanNode(*this);
+	}
+
 	PrintNode::PrintNode(ExpressionNode *child) : Function1Node(child)
 	{
 	}
@@ -1357,6 +2288,17 @@ namespace orchestracpp
 		return tmp;
 	}
 
+	int PrintNode::compile(ExpressionProgram* program)
+	{
+		program->nrPrintNodes++;
+		return program->compile(child);
+	}
+
+	ExpressionNode* PrintNode::copy(Parser* parser)
+	{
+		return new (parser) PrintNode(*this);
+	}
+
 	BExpressionNode::BExpressionNode(ExpressionNode *left, ExpressionNode *right)
 	{
 		this->left = left;
@@ -1387,6 +2329,17 @@ namespace orchestracpp
 		return;// this;
 	}
 
+	std::string BExpressionNode::structuralKey()
+	{
+		return nodeKey(typeid(*this).name(), left, right);
+	}
+
+	void BExpressionNode::getChildren(std::vector<ExpressionNode**>& children)
+	{
+		children.push_back(&left);
+		children.push_back(&right);
+	}
+
 	EQNode::EQNode(ExpressionNode *left, ExpressionNode *right) : BExpressionNode(left, right)
 	{
 	}
@@ -1396,6 +2349,11 @@ namespace orchestracpp
 		return (left->evaluate() == right->evaluate());
 	}
 
+	int EQNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::EQ, program->compile(left), program->compile(right));
+	}
+
 
 	Not::Not(BExpressionNode *child) : BExpressionNode(nullptr, nullptr)
 	{
@@ -1407,6 +2365,21 @@ namespace orchestracpp
 		return !child->evaluate();
 	}
 
+	int Not::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::NOT, program->compile(child));
+	}
+
+	std::string Not::structuralKey()
+	{
+		return nodeKey("not", child);
+	}
+
+	void Not::getChildren(std::vector<ExpressionNode**>& children)
+	{
+		child->getChildren(children);
+	}
+
 	LTNode::LTNode(ExpressionNode *left, ExpressionNode *right) : BExpressionNode(left, right)
 	{
 	}
@@ -1416,6 +2389,11 @@ namespace orchestracpp
 		return (left->evaluate() < right->evaluate());
 	}
 
+	int LTNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::LT, program->compile(left), program->compile(right));
+	}
+
 	GTNode::GTNode(ExpressionNode *left, ExpressionNode *right) : BExpressionNode(left, right)
 	{
 	}
@@ -1425,6 +2403,11 @@ namespace orchestracpp
 		return (left->evaluate() > right->evaluate());
 	}
 
+	int GTNode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::GT, program->compile(left), program->compile(right));
+	}
+
 	LENode::LENode(ExpressionNode *left, ExpressionNode *right) : BExpressionNode(left, right)
 	{
 	}
@@ -1434,6 +2417,11 @@ namespace orchestracpp
 		return (left->evaluate() <= right->evaluate());
 	}
 
+	int LENode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::LE, program->compile(left), program->compile(right));
+	}
+
 	GENode::GENode(ExpressionNode *left, ExpressionNode *right) : BExpressionNode(left, right)
 	{
 	}
@@ -1442,4 +2430,9 @@ namespace orchestracpp
 	{
 		return (left->evaluate() >= right->evaluate());
 	}
+
+	int GENode::compile(ExpressionProgram* program)
+	{
+		return program->addInstruction(ExpressionProgram::GE, program->compile(left), program->compile(right));
+	}
 }
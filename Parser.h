@@ -2,7 +2,10 @@
 
 #include "ExpressionNode.h"
 #include <string>
+#include <string_view>
+#include <cstdint>
 #include <map>
+#include <unordered_map>
 #include <unordered_set>
 #include <algorithm>
 #include <vector>
@@ -11,6 +14,7 @@
 #include <typeinfo>
 #include "OrchestraException.h"
 #include "VarGroup.h"
+#include "ExpressionProgram.h"
 
 namespace orchestracpp { class ParserException; }
 namespace orchestracpp { class MemoryNode; }
@@ -46,6 +50,7 @@ namespace orchestracpp
 	 * max(<expression>,<expression>) min(<expression>,<expression>)
 	 * if(<condition>,<expression>,<expression>) // condition =  <expression>[<,>, <=,
 	 * >=, ==]<expression>
+	 * sum(<vector>) dot(<vector or table>,<vector or table>)
 	 *
 	         print(<expression>)
 	 *
@@ -57,11 +62,51 @@ namespace orchestracpp
 
 	public:
 
-		std::map<std::string, NumberNode*> constants; // static set of unique constants
+		std::unordered_map<uint64_t, NumberNode*> constants; // the unique constants, by the bit pattern of their value
 
 		std::vector<ExpressionNode*> allExpressionNodes;
 		std::vector<BExpressionNode*> allBExpressionNodes;
 
+		/**
+		 * While parsing, identical subexpressions are shared (hash-consing): the first
+		 * occurrence of a node is placed behind a memory node, later occurrences return
+		 * this memory node, so the subexpression is evaluated only once. Memory nodes with
+		 * only one reference are removed again during optimization.
+		 */
+		std::unordered_map<std::string, MemoryNode*> sharedNodes;
+		std::unordered_map<std::string, BExpressionNode*> sharedBNodes;
+		int nrMergedNodes = 0; // the number of nodes that were replaced by an existing identical node
+
+		/**
+		 * Algebraic rewrites that change the result within round-off (@rewrite: keyword):
+		 * log10(10^x) -> x, log(exp(x)) -> x, x^3 -> x*x*x, 10^a * 10^b -> 10^(a+b)
+		 * and division by a constant -> multiplication by its reciprocal.
+		 * The rewrites that give exactly the same result are always applied.
+		 */
+		bool algebraicRewrites = false;
+		int nrRewrites = 0;
+
+		/**
+		 * 10^x, log, log10 and exp are evaluated with the FastMath kernels instead of
+		 * the standard library (@fastmath: keyword). The nodes take this setting when
+		 * they are optimized.
+		 */
+		bool fastMath = false;
+
+		/**
+		 * Vectors are named lists of existing variables (@vector: keyword), tables are named lists
+		 * of numbers (@table: keyword). sum(v) and dot(a, b) expand to a sum over the
+		 * elements, which the compiler fuses into a single mass balance kernel, and
+		 * @vcalc: expressions define every element of a vector with one expression.
+		 * The numbers of a table are kept as text, so they give the same constants as
+		 * when they are written out in an expression.
+		 */
+		std::unordered_map<std::string, std::vector<std::string>> vectors;
+		std::unordered_map<std::string, std::vector<std::string>> tables;
+
+		void addVector(const std::string& name, const std::vector<std::string>& elements);
+		void addTable(const std::string& name, const std::vector<std::string>& numbers);
+
 		ExpressionNode* newNode(ExpressionNode* tmp);
 		BExpressionNode* newBNode(BExpressionNode* tmp);
 
@@ -69,18 +114,49 @@ namespace orchestracpp
 		{
 			//std::cout << "Deleting all "<< allExpressionNodes.size() <<" expression nodes " << std::endl;
 			for (auto n : allExpressionNodes) {
-				delete n;
+				n->~ExpressionNode(); // the memory belongs to the node storage
 			}
 			for (auto n : allBExpressionNodes) {
 				delete n;
 			}
-
+			for (auto b : nodeBlocks) {
+				delete[] b;
+			}
 		}
 
+		/**
+		 * Allocate memory for a node in the node storage. The nodes are stored consecutively
+		 * in large blocks, as they are created bottom up this is also the evaluation order.
+		 */
+		void* allocate(std::size_t size);
+
+		/**
+		 * Moves all nodes that can be reached from the expressions of these variables into a
+		 * new node storage, in evaluation order, and deletes the nodes that were removed by
+		 * the optimization. Returns the number of removed nodes.
+		 */
+		int compact(std::vector<Var*>& roots);
+
+		int nrRemovedNodes = 0;
+
 		static void main(std::string args[]);
 
 	private:
 		VarGroup * variables; // The variables group that the parser operates on.
+		bool parsing = false;
+
+		/**
+		 * A node that is replaced by an existing identical node releases the references its
+		 * children took on their memory nodes. Children that were merged themselves are then
+		 * part of the merged node, so they are not counted as merged separately.
+		 */
+		void releaseChildren(std::vector<ExpressionNode**>& children, size_t first);
+
+		std::vector<char*> nodeBlocks; // the node storage
+		std::size_t blockUsed = 0;
+		static const std::size_t blockSize = 64 * 1024;
+
+		ExpressionNode* relocate(ExpressionNode* node, std::unordered_map<ExpressionNode*, ExpressionNode*>& copies);
 
 		/*
 		 * A static method to evaluate a given expresson in a string
@@ -136,6 +212,17 @@ namespace orchestracpp
 		ExpressionNode *parseElement(ParserStringTokenizer *stream)/* throw(ParserException)*/;
 
 		BExpressionNode *parseBElement(ParserStringTokenizer *stream)/* throw(ParserException)*/;
+
+		/**
+		 * The node for a variable used as operand: its memory node if it is the result of an expression.
+		 */
+		ExpressionNode *variableNode(Var *variable);
+
+		/**
+		 * The operand of sum() and dot(): the elements of a vector or the numbers of a table,
+		 * with nullptr for the zero entries of a table.
+		 */
+		void parseElements(ParserStringTokenizer *stream, std::vector<ExpressionNode*>& elements)/* throw(ParserException)*/;
 	}; //-----------------------------------------------------------------------------------------
 
 	/**
@@ -158,11 +245,21 @@ namespace orchestracpp
 		/**
 		 * This method creates all new nodes
 		 */
-		static NumberNode *createNumberNode(const std::string &name, Parser* parser);
+		static NumberNode *createNumberNode(std::string_view name, Parser* parser);
 
 		static NumberNode *createNumberNode(double value, Parser* parser);
 
-		NumberNode(const std::string &name, Parser* parser);
+		/**
+		 * Creates a number node with exactly this value (the other methods round to 12-14 digits)
+		 */
+		static NumberNode *createExactNumberNode(double value, Parser* parser);
+
+		NumberNode(double value);
+
+		/**
+		 * Returns the unique number node with exactly this value.
+		 */
+		static NumberNode *internNumberNode(double value, Parser* parser);
 		
 	public:
 		double evaluate() override;
@@ -173,6 +270,12 @@ namespace orchestracpp
 
 		ExpressionNode *optimize(Parser* parser) override;
 
+		int compile(ExpressionProgram* program) override;
+
+		void getChildren(std::vector<ExpressionNode**>& children) override;
+
+		ExpressionNode* copy(Parser* parser) override;
+
 	//    public String toString() {
 	//        return Double.toString(value);
 	//    }
@@ -203,6 +306,14 @@ namespace orchestracpp
 
 		ExpressionNode *optimize(Parser* parser) override;
 
+		int compile(ExpressionProgram* program) override;
+
+		void getChildren(std::vector<ExpressionNode**>& children) override;
+
+		ExpressionNode* copy(Parser* parser) override;
+
+		std::string structuralKey() override;
+
 	//    public String toString() {
 	//        return ("abs(" + child.toString() + ")");
 	//    }
@@ -232,6 +343,14 @@ namespace orchestracpp
 
 		ExpressionNode *optimize(Parser* parser) override;
 
+		int compile(ExpressionProgram* program) override;
+
+		void getChildren(std::vector<ExpressionNode**>& children) override;
+
+		ExpressionNode* copy(Parser* parser) override;
+
+		std::string structuralKey() override;
+
 	//    public String toString() {
 	//        return ("-" + child.toString());
 	//    }
@@ -259,6 +378,14 @@ namespace orchestracpp
 
 		ExpressionNode *optimize(Parser* parser) override;
 
+		int compile(ExpressionProgram* program) override;
+
+		void getChildren(std::vector<ExpressionNode**>& children) override;
+
+		ExpressionNode* copy(Parser* parser) override;
+
+		std::string structuralKey() override;
+
 
 		std::vector<PlusNode*>* findMultiPlusNode(std::vector<PlusNode*>*);
 
@@ -292,6 +419,12 @@ namespace orchestracpp
 
 		ExpressionNode* optimize(Parser* parser) override;
 
+		int compile(ExpressionProgram* program) override;
+
+		void getChildren(std::vector<ExpressionNode**>& children) override;
+
+		ExpressionNode* copy(Parser* parser) override;
+
 
 		//    public String toString() {
 		//        return ("(" + left.toString() + "+" + right.toString() + ")");
@@ -299,6 +432,44 @@ namespace orchestracpp
 	}; //-----------------------------------------------------------------------------------------
 
 
+	/**
+	 * A product of more than two factors, created from a chain of left nested
+	 * TimesNodes. The factors are multiplied in the same order as in the chain.
+	 */
+	class MultiTimesNode final : public ExpressionNode
+	{ //------------------------------------------
+
+	private:
+		int nrChildren = 0;
+		ExpressionNode** childRefs;
+
+	public:
+		~MultiTimesNode()
+		{
+			delete[] childRefs;
+		}
+
+		MultiTimesNode(const std::vector<ExpressionNode*>& children);
+
+		double evaluate() override;
+
+		void setDependentMemoryNode(MemoryNode* parent) override;
+
+		bool constant() override;
+
+		ExpressionNode* optimize(Parser* parser) override;
+
+		int compile(ExpressionProgram* program) override;
+
+		void getChildren(std::vector<ExpressionNode**>& children) override;
+
+		ExpressionNode* copy(Parser* parser) override;
+
+		/**
+		 * Adds the factors of this node to the list.
+		 */
+		void getFactors(std::vector<ExpressionNode*>& factors);
+	}; //-----------------------------------------------------------------------------------------
 
 
 
@@ -326,6 +497,14 @@ namespace orchestracpp
 
 		ExpressionNode *optimize(Parser* parser) override;
 
+		int compile(ExpressionProgram* program) override;
+
+		void getChildren(std::vector<ExpressionNode**>& children) override;
+
+		ExpressionNode* copy(Parser* parser) override;
+
+		std::string structuralKey() override;
+
 	//    public String toString() {
 	//        return ("(" + left.toString() + "-" + right.toString() + ")");
 	//    }
@@ -353,6 +532,14 @@ namespace orchestracpp
 
 		ExpressionNode *optimize(Parser* parser) override;
 
+		int compile(ExpressionProgram* program) override;
+
+		void getChildren(std::vector<ExpressionNode**>& children) override;
+
+		ExpressionNode* copy(Parser* parser) override;
+
+		std::string structuralKey() override;
+
 	//    public String toString() {
 	//        return ("(" + left.toString() + "*" + right.toString() + ")");
 	//    }
@@ -380,6 +567,14 @@ namespace orchestracpp
 
 		ExpressionNode *optimize(Parser* parser) override;
 
+		int compile(ExpressionProgram* program) override;
+
+		void getChildren(std::vector<ExpressionNode**>& children) override;
+
+		ExpressionNode* copy(Parser* parser) override;
+
+		std::string structuralKey() override;
+
 	//    public String toString() {
 	//        return ("(" + left.toString() + "/" + right.toString() + ")");
 	//    }
@@ -407,6 +602,14 @@ namespace orchestracpp
 
 		ExpressionNode *optimize(Parser* parser) override;
 
+		int compile(ExpressionProgram* program) override;
+
+		void getChildren(std::vector<ExpressionNode**>& children) override;
+
+		ExpressionNode* copy(Parser* parser) override;
+
+		std::string structuralKey() override;
+
 	//    public String toString() {
 	//        return ("max(" + left.toString() + "," + right.toString() + ")");
 	//    }
@@ -436,6 +639,14 @@ namespace orchestracpp
 
 		ExpressionNode *optimize(Parser* parser) override;
 
+		int compile(ExpressionProgram* program) override;
+
+		void getChildren(std::vector<ExpressionNode**>& children) override;
+
+		ExpressionNode* copy(Parser* parser) override;
+
+		std::string structuralKey() override;
+
 	//    public String toString() {
 	//        return ("min(" + left.toString() + "," + right.toString() + ")");
 	//    }
@@ -464,6 +675,14 @@ namespace orchestracpp
 
 		ExpressionNode *optimize(Parser* parser) override;
 
+		int compile(ExpressionProgram* program) override;
+
+		void getChildren(std::vector<ExpressionNode**>& children) override;
+
+		ExpressionNode* copy(Parser* parser) override;
+
+		std::string structuralKey() override;
+
 	//    public String toString() {
 	//        return ("(" + left.toString() + "^" + right.toString() + ")");
 	//    }
@@ -472,8 +691,9 @@ namespace orchestracpp
 	class Power10Node final : public ExpressionNode
 	{ //-----------------------------------------
 
-	private:
+	public:
 		ExpressionNode *right;
+		bool fastMath = false;
 
 	public:
 		~Power10Node()
@@ -490,6 +710,14 @@ namespace orchestracpp
 
 		ExpressionNode *optimize(Parser* parser) override;
 
+		int compile(ExpressionProgram* program) override;
+
+		void getChildren(std::vector<ExpressionNode**>& children) override;
+
+		ExpressionNode* copy(Parser* parser) override;
+
+		std::string structuralKey() override;
+
 	//    public String toString() {
 	//        return ("(10^" + right.toString() + ")");
 	//    }
@@ -526,6 +754,14 @@ namespace orchestracpp
 
 		ExpressionNode *optimize(Parser* parser) override;
 
+		int compile(ExpressionProgram* program) override;
+
+		void getChildren(std::vector<ExpressionNode**>& children) override;
+
+		ExpressionNode* copy(Parser* parser) override;
+
+		std::string structuralKey() override;
+
 	//    public String toString() {
 	//        return ("(if(" + condition + "," + left.toString() + "," + right.toString() + ")");
 	//    }
@@ -547,6 +783,8 @@ namespace orchestracpp
 		bool constant()override;
 
 		ExpressionNode *optimize(Parser* parser)override;
+		void getChildren(std::vector<ExpressionNode**>& children)override;
+		std::string structuralKey()override;
 		
         ~Function1Node(){}
 		
@@ -565,6 +803,9 @@ namespace orchestracpp
 
 		double evaluate() override;
 
+		int compile(ExpressionProgram* program) override;
+		ExpressionNode* copy(Parser* parser) override;
+
 	//    public String toString() {
 	//        return ("sqrt(" + child.toString() + ")");
 	//    }
@@ -578,6 +819,9 @@ namespace orchestracpp
 
 		double evaluate() override;
 
+		int compile(ExpressionProgram* program) override;
+		ExpressionNode* copy(Parser* parser) override;
+
 		//    public String toString() {
 		//        return ("sqrt(" + child.toString() + ")");
 		//    }
@@ -587,10 +831,17 @@ namespace orchestracpp
 	{
 
 	public:
+		bool fastMath = false;
+
 		LogNode(ExpressionNode *child);
 
 		double evaluate() override;
 
+		ExpressionNode *optimize(Parser* parser) override;
+
+		int compile(ExpressionProgram* program) override;
+		ExpressionNode* copy(Parser* parser) override;
+
 	//    public String toString() {
 	//        return ("log(" + child.toString() + ")");
 	//    }
@@ -600,10 +851,17 @@ namespace orchestracpp
 	{
 
 	public:
+		bool fastMath = false;
+
 		Log10Node(ExpressionNode *child);
 
 		double evaluate() override;
 
+		ExpressionNode *optimize(Parser* parser) override;
+
+		int compile(ExpressionProgram* program) override;
+		ExpressionNode* copy(Parser* parser) override;
+
 	//    public String toString() {
 	//        return ("log10(" + child.toString() + ")");
 	//    }
@@ -613,10 +871,17 @@ namespace orchestracpp
 	{
 
 	public:
+		bool fastMath = false;
+
 		ExpNode(ExpressionNode *child);
 
 		double evaluate() override;
 
+		ExpressionNode *optimize(Parser* parser) override;
+
+		int compile(ExpressionProgram* program) override;
+		ExpressionNode* copy(Parser* parser) override;
+
 	//    public String toString() {
 	//        return ("exp(" + child.toString() + ")");
 	//    }
@@ -630,6 +895,9 @@ namespace orchestracpp
 
 		double evaluate() override;
 
+		int compile(ExpressionProgram* program) override;
+		ExpressionNode* copy(Parser* parser) override;
+
 	//    public String toString() {
 	//        return ("sin(" + child.toString() + ")");
 	//    }
@@ -643,6 +911,9 @@ namespace orchestracpp
 
 		double evaluate() override;
 
+		int compile(ExpressionProgram* program) override;
+		ExpressionNode* copy(Parser* parser) override;
+
 	//    public String toString() {
 	//        return ("cos(" + child.toString() + ")");
 	//    }
@@ -656,6 +927,9 @@ namespace orchestracpp
 
 		double evaluate() override;
 
+		int compile(ExpressionProgram* program) override;
+		ExpressionNode* copy(Parser* parser) override;
+
 	//    public String toString() {
 	//        return ("tan(" + child.toString() + ")");
 	//    }
@@ -669,6 +943,9 @@ namespace orchestracpp
 
 		double evaluate() override;
 
+		int compile(ExpressionProgram* program) override;
+		ExpressionNode* copy(Parser* parser) override;
+
 	//    public String toString() {
 	//        return ("sinh(" + child.toString() + ")");
 	//    }
@@ -682,6 +959,9 @@ namespace orchestracpp
 
 		double evaluate() override;
 
+		int compile(ExpressionProgram* program) override;
+		ExpressionNode* copy(Parser* parser) override;
+
 	//    public String toString() {
 	//        return ("cosh(" + child.toString() + ")");
 	//    }
@@ -695,6 +975,9 @@ namespace orchestracpp
 
 		double evaluate() override;
 
+		int compile(ExpressionProgram* program) override;
+		ExpressionNode* copy(Parser* parser) override;
+
 	//    public String toString() {
 	//        return ("tanh(" + child.toString() + ")");
 	//    }
@@ -708,6 +991,9 @@ namespace orchestracpp
 
 		double evaluate() override;
 
+		int compile(ExpressionProgram* program) override;
+		ExpressionNode* copy(Parser* parser) override;
+
 	//    public String toString() {
 	//        return ("atan(" + child.toString() + ")");
 	//    }
@@ -721,6 +1007,10 @@ namespace orchestracpp
 
 		double evaluate() override;
 
+		int compile(ExpressionProgram* program) override;
+		ExpressionNode* copy(Parser* parser) override;
+		std::string structuralKey() override { return ""; } // every print() is kept, also if identical
+
 	//    public String toString() {
 	//        return ("print(" + child.toString() + ")");
 	//    }
@@ -765,6 +1055,8 @@ namespace orchestracpp
 
 		bool evaluate() override;
 
+		int compile(ExpressionProgram* program) override;
+
 		//std::string toString();
 	};
 
@@ -780,6 +1072,10 @@ namespace orchestracpp
 		Not(BExpressionNode *child);
 
 		bool evaluate() override;
+
+		int compile(ExpressionProgram* program) override;
+		std::string structuralKey() override;
+		void getChildren(std::vector<ExpressionNode**>& children) override;
 	};
 
 	class LTNode final : public BExpressionNode
@@ -791,6 +1087,8 @@ namespace orchestracpp
 		LTNode(ExpressionNode *left, ExpressionNode *right);
 
 		bool evaluate() override;
+
+		int compile(ExpressionProgram* program) override;
 	};
 
 	class GTNode final : public BExpressionNode
@@ -803,6 +1101,8 @@ namespace orchestracpp
 
 		bool evaluate() override;
 
+		int compile(ExpressionProgram* program) override;
+
 	//    public String toString() {
 	//        return ("(" + left.toString() + ">" + right.toString() + ")");
 	//    }
@@ -818,6 +1118,8 @@ namespace orchestracpp
 		LENode(ExpressionNode *left, ExpressionNode *right);
 
 		bool evaluate() override;
+
+		int compile(ExpressionProgram* program) override;
 	};
 
 	class GENode final : public BExpressionNode
@@ -830,6 +1132,8 @@ namespace orchestracpp
 		GENode(ExpressionNode *left, ExpressionNode *right);
 
 		bool evaluate() override;
+
+		int compile(ExpressionProgram* program) override;
 	};
 
 
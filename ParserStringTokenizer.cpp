@@ -2,6 +2,8 @@
 #include "stringhelper.h"
 #include "VarGroup.h"
 #include "IO.h"
+#include <charconv>
+#include <cctype>
 
 namespace orchestracpp
 {
@@ -12,12 +14,12 @@ namespace orchestracpp
 		tokenizer = new StringTokenizer(this->expression," \t*/+-()^!<>&|,={}",true);
 	}
 	
-	std::string ParserStringTokenizer::getCurrentToken()
+	std::string_view ParserStringTokenizer::getCurrentToken()
 	{
 		return currentToken;
 	}
 
-	std::string ParserStringTokenizer::nextToken()// throw(ParserException)
+	std::string_view ParserStringTokenizer::nextToken()// throw(ParserException)
 	{
 		if (currentToken == "")
 		{ // eat spaces
@@ -37,37 +39,33 @@ namespace orchestracpp
 
 		if (!hasMoreTokens() && (currentToken == ""))
 		{
-			return "";
+			return std::string_view();
 		}
 
 		// return complete nextToken within {} without parsing
 		if (currentToken == "{")
 		{
-            std::string tmpToken;
+			size_t start = tokenizer->getPosition();
 			while (true)
 			{
-				std::string tmp = tokenizer->nextToken();
+				std::string_view tmp = tokenizer->nextToken();
 				if (tmp == "}")
 				{
-					currentToken = tmpToken; 
+					// the tokens in between are contiguous in the expression
+					currentToken = std::string_view(expression).substr(start, tokenizer->getPosition() - 1 - start);
 					break;
 				}
-				else
-				{
-					tmpToken = tmpToken + tmp;
-				}
 
 				if (!hasMoreTokens())
 				{
-					//delete tmpToken;
-					throw OrchestraException("No matching } in expression: {" + currentToken);
+					throw OrchestraException("No matching } in expression: {" + std::string(std::string_view(expression).substr(start)));
 				}
 			}
 		}
 
 		// If nextToken starts with a digit and ends with 'e' then this nextToken could be the first part of a number
 		// that has a negative exponent e.g 3.07e-7
-		if ((currentToken[0] >= '0') && (currentToken[0] <= '9'))
+		if (!currentToken.empty() && (currentToken[0] >= '0') && (currentToken[0] <= '9'))
 		{
 			if ((currentToken[currentToken.length() - 1] == 'e') || (currentToken[currentToken.length() - 1] == 'E'))
 			{
@@ -80,8 +78,11 @@ namespace orchestracpp
 					//double test = std::stod(currentToken.substr(0, (currentToken.length() - 1)));
 					
 				if (isaNumber(currentToken.substr(0, (currentToken.length() - 1)))) {
-					currentToken = currentToken + tokenizer->nextToken();
-					currentToken = currentToken + tokenizer->nextToken();
+					// add the sign and the exponent
+					size_t start = currentToken.data() - expression.data();
+					tokenizer->nextToken();
+					tokenizer->nextToken();
+					currentToken = std::string_view(expression).substr(start, tokenizer->getPosition() - start);
 				}
 				else {
 					//This was not a number, simply return nextToken
@@ -113,13 +114,13 @@ namespace orchestracpp
 
 	void ParserStringTokenizer::consume()
 	{
-		currentToken = "";
+		currentToken = std::string_view();
 	}
 
 
 	bool ParserStringTokenizer::match(const std::string &s)// throw(ParserException)
 	{
-		std::string tmptoken = nextToken();
+		std::string_view tmptoken = nextToken();
 		if (tmptoken == "")
 		{
 			return false;
@@ -144,14 +145,21 @@ namespace orchestracpp
 		matchAndConsume(s, "\"" + s + "\" expected!!");
 	}
 
-	bool ParserStringTokenizer::equals(const std::string &s) //throw(ParserException)
+	bool ParserStringTokenizer::equals(std::string_view s) //throw(ParserException)
 	{
-		std::string tmptoken = nextToken();
-		if (tmptoken == "")
+		std::string_view tmptoken = nextToken();
+		if ((tmptoken == "") || (tmptoken.length() != s.length()))
 		{
 			return false;
 		}
-		return (StringHelper::toLower(s)==(StringHelper::toLower(tmptoken)));
+		for (size_t n = 0; n < s.length(); n++)
+		{
+			if (std::tolower((unsigned char)s[n]) != std::tolower((unsigned char)tmptoken[n]))
+			{
+				return false;
+			}
+		}
+		return true;
 	}
 
 	bool ParserStringTokenizer::hasMoreTokens()
@@ -208,25 +216,16 @@ namespace orchestracpp
 		return isaNumber(currentToken);
 	}
 
-	bool ParserStringTokenizer::isaNumber(const std::string s) {
-		long double ld;
-		return((std::istringstream(s) >> ld >> std::ws).eof());
-
-		/*
-		long double ld;
-		if ((std::istringstream(s) >> ld >> std::ws).eof()) {
-			return true;
-		}
-		else {
+	bool ParserStringTokenizer::isaNumber(std::string_view s) {
+		// The complete token should be a number, so strings that start with a number
+		// (2KO3-) or a nan or inf (nantokite, NaNO3-, info) are not numbers
+		if (s.empty() || !(std::isdigit((unsigned char)s[0]) || (s[0] == '.')))
+		{
 			return false;
 		}
-		*/
-		// Return true on valid
-	//	bool valid_string_to_double(const char* s) {
-	//		char* end;
-	//		strtod(s, &end);
-	//		return s != end;
-		
+		double d;
+		auto result = std::from_chars(s.data(), s.data() + s.length(), d);
+		return (result.ptr == s.data() + s.length()) && (result.ptr != s.data());
 	}
 
 	Var *ParserStringTokenizer::isVariable(VarGroup *variables)
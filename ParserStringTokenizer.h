@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include "StringTokenizer.h"
 #include "OrchestraException.h"
 
@@ -13,13 +14,15 @@ namespace orchestracpp
 	/**
 	 * This string tokenizer splits up a string in tokens.
 	 * It does not remove the delimiter characters
+	 * The tokens are views of the expression string, so they are only valid
+	 * as long as the tokenizer exists.
 	 */
 	class ParserStringTokenizer final
 	{
 	private:
 		std::string expression; // the expression string
 		StringTokenizer *tokenizer = nullptr;
-		std::string currentToken; // the current nextToken, can be null;
+		std::string_view currentToken; // the current nextToken, can be empty;
 
 	public:
         
@@ -32,9 +35,9 @@ namespace orchestracpp
 
 		ParserStringTokenizer(const std::string &expression);
 
-	    std::string getCurrentToken();
+	    std::string_view getCurrentToken();
 
-		std::string nextToken() /*throw(ParserException)*/;
+		std::string_view nextToken() /*throw(ParserException)*/;
 
 		void consume();
 
@@ -46,13 +49,14 @@ namespace orchestracpp
 	public:
 		void matchAndConsume(const std::string &s)/* throw(ParserException)*/;
 
-		bool equals(const std::string &s)/* throw(ParserException)*/;
+		// case insensitive
+		bool equals(std::string_view s)/* throw(ParserException)*/;
 
 		bool hasMoreTokens();
 
 		bool isNumber();
 
-		bool isaNumber(const std::string);
+		static bool isaNumber(std::string_view s);
 
         Var *isVariable(VarGroup *variables);
 
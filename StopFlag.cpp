@@ -10,12 +10,27 @@ namespace orchestracpp
 
 	bool StopFlag::isCancelled()
 	{
-		return cancelled;
+		return cancelled || deadlinePassed();
+	}
+
+	void StopFlag::setDeadline(double seconds)
+	{
+		hasDeadline = seconds > 0;
+		if (hasDeadline)
+		{
+			deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+		}
+	}
+
+	bool StopFlag::deadlinePassed()
+	{
+		return hasDeadline && (std::chrono::steady_clock::now() > deadline);
 	}
 
 	void StopFlag::addChild(StopFlag *child)
 	{
 		children.push_back(child);
+		child->parent = this;
 	}
 
 	void StopFlag::removeChild(StopFlag *child)
@@ -23,6 +38,7 @@ namespace orchestracpp
 		std::vector<StopFlag*>::iterator position = std::find(children.begin(), children.end(), child);
 		if (position != children.end()) {
 			children.erase(position);
+			child->parent = nullptr;
 		}
 
 		// java children.remove(child);
@@ -44,4 +60,13 @@ namespace orchestracpp
 			s->pleaseStop("Stopping a child flag!");
 		}
 	}
+
+	void StopFlag::pleaseStopAll(const std::string &calledFrom)
+	{
+		StopFlag* root = this;
+		while (root->parent != nullptr) {
+			root = root->parent;
+		}
+		root->pleaseStop(calledFrom);
+	}
 }
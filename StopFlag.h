@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <atomic>
+#include <chrono>
 
 namespace orchestracpp
 {
@@ -25,6 +26,11 @@ namespace orchestracpp
 
 	private:
 		std::vector<StopFlag*> children;
+		StopFlag* parent = nullptr;
+
+		// optional wall clock deadline, only set and read by the thread that owns this flag
+		bool hasDeadline = false;
+		std::chrono::steady_clock::time_point deadline;
 
 	public:
 		StopFlag();
@@ -37,11 +43,24 @@ namespace orchestracpp
 
 		void reset();
 
+		/**
+		 * Set a wall clock deadline, after which this flag reports cancelled.
+		 * A time budget <= 0 removes the deadline.
+		 */
+		void setDeadline(double seconds);
+
+		bool deadlinePassed();
+
 		/**
 		 * stops all children, but not the parent!
 		 */
 		void pleaseStop(const std::string &calledFrom);
 
+		/**
+		 * stops the topmost parent, and so all flags that share it
+		 */
+		void pleaseStopAll(const std::string &calledFrom);
+
 	};
 
 }
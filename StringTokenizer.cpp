@@ -8,13 +8,17 @@
 #include "StringTokenizer.h"
 
 
-   StringTokenizer::StringTokenizer(const std::string& s, const char* delim = NULL, bool includeDel = true) :
+   StringTokenizer::StringTokenizer(std::string_view s, const char* delim = NULL, bool includeDel = true) :
        inputstring(s), includeDelimiters(includeDel),pos(0) {
 
        if (!delim)
-          delimiters = " \f\n\r\t\v";  //default to whitespace
-       else{
-          delimiters = delim;
+          delim = " \f\n\r\t\v";  //default to whitespace
+
+       for (int n = 0; n < 256; n++) {
+          delimiters[n] = false;
+       }
+       for (const char* c = delim; *c != 0; c++) {
+          delimiters[(unsigned char)*c] = true;
        }
     }
     
@@ -31,19 +35,20 @@
     }
     
    bool StringTokenizer::isDelimiter(const char& s){
-        if (delimiters.find(s) != std::string::npos) {
-            return true;
-        }
-        return false;
+        return delimiters[(unsigned char)s];
     }
 
-    
-    std::string StringTokenizer::nextToken() {
+    size_t StringTokenizer::getPosition() {
+        return pos;
+    }
+
+    // the tokens are views of the input string, nothing is copied
+    std::string_view StringTokenizer::nextToken() {
 
         if(hasMoreTokens()) {
             if (isDelimiter(inputstring[pos])){
                 if(includeDelimiters){
-                   return std::string (1, inputstring[pos++]); // return the delimiter
+                   return inputstring.substr(pos++, 1); // return the delimiter
                 }else{
                     skipDelimiters();
                 }
@@ -51,16 +56,15 @@
         }
         
         if(hasMoreTokens()) {
-                std::string tmptoken = "";
+                size_t start = pos;
                 do{
-                    tmptoken = tmptoken + std::string (1, inputstring[pos]);
                     pos++;
                     if (pos>=inputstring.length()){break;}
                 }while(!isDelimiter(inputstring[pos]));
-            return tmptoken;
+            return inputstring.substr(start, pos - start);
         }
             
-        return "";
+        return std::string_view();
         
     }
 
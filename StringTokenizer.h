@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <iostream>
 
 
@@ -14,14 +15,14 @@ class StringTokenizer final {
 private:
     StringTokenizer();
     
-    std::string delimiters;
-    std::string inputstring;
+    bool delimiters[256];        // lookup table of the delimiter characters
+    std::string_view inputstring; // the input string is not copied, so it should outlive the tokenizer
     bool includeDelimiters;
-    long pos; // position points to start position of next token
+    size_t pos; // position points to start position of next token
     
 public:
     
-    StringTokenizer(const std::string& , const char*, bool);
+    StringTokenizer(std::string_view, const char*, bool);
 
     bool hasMoreTokens();
     
@@ -29,5 +30,7 @@ public:
     
     bool isDelimiter(const char& s);
     
-    std::string nextToken();
+    size_t getPosition();
+
+    std::string_view nextToken();
 };
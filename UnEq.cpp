@@ -7,6 +7,7 @@
 #include "IO.h"
 #include "OrchestraException.h"
 #include "stringhelper.h"
+#include "FastMath.h"
 
 namespace orchestracpp
 {
@@ -191,50 +192,98 @@ namespace orchestracpp
 
 		// this one was used after March2020 needs to be tested!!
 
-		void UnEq::determineDeltaUnknown() { // this one does not work yet
+		void UnEq::determineDeltaUnknown() {
 
 
+			un_delta = defaultDeltaUnknown(unknown->getIniValue());
+
+			if (adaptiveDelta && (curvature > 0)) {
+				// The optimal delta for a forward difference is 2 sqrt(noise / curvature),
+				// with noise the round-off error in the equation value.
+				// For a central difference the truncation error is of second order, the optimal
+				// delta is then cbrt(3 noise / third derivative). Only the curvature (the second
+				// derivative) is tracked, so it stands in for the third derivative here. This is a
+				// heuristic, the bounds below keep the delta within range of the default.
+				// The equation value at the central point is the central residual plus the ini value.
+				double equationValue = std::abs(centralResidual + equation->getIniValue());
+				double noise = std::numeric_limits<double>::epsilon() * std::max(equationValue, std::abs(equation->getIniValue()));
+				double delta = centralDelta ? std::cbrt(3 * noise / curvature) : 2 * std::sqrt(noise / curvature);
+
+				// stay within reasonable bounds of the default delta
+				double defaultDelta = std::abs(un_delta);
+				delta = std::min(std::max(delta, 1e-4 * defaultDelta), 10 * defaultDelta);
+
+				un_delta = (un_delta >= 0) ? delta : -delta;
+			}
+		}
+
+		double UnEq::defaultDeltaUnknown(double value) const
+		{
+			double delta;
 			if (un_type == lin) {
-				if (unknown->getIniValue() >= 0) {
-					un_delta = 1e-3;
+				if (value >= 0) {
+					delta = 1e-3;
 				}
 				else {
 					// inivalue<0
-					un_delta = -1e-3;
-					//IO.println(unknown.name+""+un_delta);
+					delta = -1e-3;
 				}
 			}
 			else {// not linear so use relative delta
-				un_delta = unknown->getIniValue() * un_rel_delta;
-				if (un_delta >= 0) {
-					if (un_delta < un_min_delta) {
-						un_delta = un_min_delta;
+				delta = value * un_rel_delta;
+				if (delta >= 0) {
+					if (delta < un_min_delta) {
+						delta = un_min_delta;
 					}
 				}
-				else {// un_delta < 0
-					if (un_delta > -un_min_delta) {
-						un_delta = -un_min_delta;
+				else {// delta < 0
+					if (delta > -un_min_delta) {
+						delta = -un_min_delta;
 					}
 				}
 			}
+			return delta;
+		}
+
+		void UnEq::updateCurvature(double derivative)
+		{
+			double coordinate = unknown->getIniValue();
+			if (un_type == log) {
+				coordinate = std::log10(coordinate);
+			}
 
+			if (hasLastDerivative && (coordinate != lastCoordinate) && std::isfinite(derivative)) {
+				curvature = std::abs((derivative - lastDerivative) / (coordinate - lastCoordinate));
+			}
+
+			lastDerivative = derivative;
+			lastCoordinate = coordinate;
+			hasLastDerivative = std::isfinite(derivative) && std::isfinite(coordinate);
+		}
+
+		void UnEq::resetCurvature()
+		{
+			curvature = 0;
+			hasLastDerivative = false;
 		}
 
 
 		double UnEq::checkUnknownStep()
+		{
+			factor = stepFactor(unknown->getIniValue(), centralResidual);
+			return factor;
+		}
+
+		double UnEq::stepFactor(double value, double residual) const
 		{
 			double step;
-			step = -centralResidual;
+			step = -residual;
 
 			if (step == 0.0)
 			{
-				factor = 1;
-				return factor;
+				return 1;
 			}
 
-
-			double value = unknown->getIniValue();
-
 			if ((step > 0) && (step > un_max_abs_step))
 			{
 				step = un_max_abs_step;
@@ -253,26 +302,23 @@ namespace orchestracpp
 				step = (un_min + value) / 2 - value;
 			}
 
-			factor = (step / -centralResidual);
-
-			return factor;
+			return (step / -residual);
 		}
 
 		void UnEq::updateUnknown(double factor)
 		{
 			//unknown.setValue(unknown.getIniValue() + -centralResidual * factor);
+			unknown->setValue(offsetValue(unknown->getIniValue(), -centralResidual * factor));
+		}
 
+		double UnEq::offsetValue(double value, double delta) const
+		{
 			if (un_type == lin)
 			{
-				unknown->setValue(unknown->getIniValue() + -centralResidual * factor);
-			}
-			else
-			{ //log
-				unknown->setValue(unknown->getIniValue() * std::pow(10, -centralResidual * factor));
+				return value + delta;
 			}
-
-
-
+			// un_type == log
+			return value * (fastMath ? FastMath::exp10(delta) : std::pow(10, delta));
 		}
 
 		/*
@@ -282,14 +328,19 @@ namespace orchestracpp
          */
 
 		double UnEq::howConvergent() //throw(OrchestraException)
+		{
+			return convergence(residual());
+		}
+
+		double UnEq::convergence(double residual) //throw(OrchestraException)
 		{
 			if (toleranceVariable != nullptr)
 			{
-				return std::abs(IO::checkNAN(residual(), nanMessage)) / toleranceVariable->getValue();
+				return std::abs(IO::checkNAN(residual, nanMessage)) / (toleranceVariable->getValue() * toleranceFactor);
 			}
 			else
 			{
-				return std::abs(IO::checkNAN(residual(), nanMessage)) / eq_tolerance;
+				return std::abs(IO::checkNAN(residual, nanMessage)) / (eq_tolerance * toleranceFactor);
 			}
 		}
 
@@ -302,18 +353,15 @@ namespace orchestracpp
 		{
 			determineDeltaUnknown();
 			double tmp = unknown->getIniValue();
-
-			if (un_type == lin)
-			{
-				unknown->setValue(tmp + un_delta);
-			}
-			else
-			{ // un_type == log
-				unknown->setValue(tmp * std::pow(10, un_delta));
-			}
+			offsetUnknown(tmp, un_delta);
 			return tmp;
 		}
 
+		void UnEq::offsetUnknown(double tmp, double delta)
+		{
+			unknown->setValue(offsetValue(tmp, delta));
+		}
+
 		void UnEq::resetUnknown(double tmp)
 		{
 			unknown->setValue(tmp);
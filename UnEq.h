@@ -52,7 +52,21 @@ namespace orchestracpp
 			double un_max_abs_step = .1; // used absolute step when lazy
 			double un_delta = 0; // delta unknown actually used
 
+			/* adaptive delta: balance truncation and round-off error with the observed curvature */
+			bool adaptiveDelta = false;
+			double curvature = 0;         // observed second derivative of the equation to the unknown
+			double lastDerivative = 0;    // diagonal jacobian value of the previous iteration
+			double lastCoordinate = 0;    // unknown (lin) or log10 unknown (log) of the previous iteration
+			bool hasLastDerivative = false;
+			bool centralDelta = false;    // the delta is used for a central difference
+
+			bool fastMath = false; // 10^x of log unknowns with FastMath::exp10 (@fastmath:)
+
+			int equationRegister = -1; // register of the equation value in the compiled expression program
+			int unknownInput = -1;     // input of the unknown in the compiled expression program, -1 if no equation depends on it
+
 			double eq_tolerance = 1e-13; // what was the orignal default value?
+			double toleranceFactor = 1;  // scales the tolerance, e.g. for loose outer iterations in transport coupling
 
 
 			bool active = true; // indicates if this uneq is switched on during the iteration
@@ -95,6 +109,22 @@ namespace orchestracpp
 
 			void dddetermineDeltaUnknown();
 
+			/**
+			 * The delta unknown for this value of the unknown, without the adaptive correction.
+			 */
+			double defaultDeltaUnknown(double value) const;
+
+			/**
+			 * Update the curvature estimate from the change of the diagonal jacobian value
+			 * (derivative of the equation to its own unknown) between iterations.
+			 */
+			void updateCurvature(double derivative);
+
+			/**
+			 * Forget the curvature of the previous node.
+			 */
+			void resetCurvature();
+
 
 
 		   /**
@@ -111,8 +141,14 @@ namespace orchestracpp
 		     */
 			double checkUnknownStep();
 
+			// the factor of checkUnknownStep for this value of the unknown and residual
+			double stepFactor(double value, double residual) const;
+
 			void updateUnknown(double factor);
 
+			// the value of the unknown after a step delta (linear) or delta in log10 (log)
+			double offsetValue(double value, double delta) const;
+
 			/*
 			 * <1 is convergent
 			 * larger than 1 means less convergent
@@ -127,11 +163,16 @@ namespace orchestracpp
 
 			double howConvergent()/* throw(OrchestraException)*/;
 
+			// the convergence for an already calculated residual
+			double convergence(double residual)/* throw(OrchestraException)*/;
+
 
 			bool isConvergent() /*throw(OrchestraException)*/;
 
 			double offsetUnknown();
 
+			void offsetUnknown(double tmp, double delta);
+
 			void resetUnknown(double tmp);
 
 
@@ -5,6 +5,8 @@
 #include "OrchestraException.h"
 #include "FileBasket.h"
 #include "stringhelper.h"
+#include <unordered_map>
+#include <algorithm>
 
 namespace orchestracpp
 {
@@ -16,6 +18,487 @@ namespace orchestracpp
 		this->variables = variables;
 	}
 
+	UnEqGroup* UnEqGroup::clone()
+	{
+		UnEqGroup* tmp = new UnEqGroup(*this);
+
+		std::unordered_map<UnEq*, UnEq*> copies;
+		copies[nullptr] = nullptr;
+		for (auto& uneq : tmp->uneqs)
+		{
+			UnEq* copy = new UnEq(*uneq);
+			copies[uneq] = copy;
+			uneq = copy;
+		}
+		for (auto& uneq : tmp->activeUneqs)
+		{
+			uneq = copies[uneq];
+		}
+		for (auto& uneq : tmp->subspaceUneqs)
+		{
+			uneq = copies[uneq];
+		}
+		for (auto& uneq : tmp->jacobianUneqs)
+		{
+			uneq = copies[uneq];
+		}
+
+		if (jacobian5 != nullptr)
+		{
+			tmp->jacobian5 = new double[olddim * olddim];
+			std::copy(jacobian5, jacobian5 + olddim * olddim, tmp->jacobian5);
+		}
+		tmp->iterationReport = nullptr;
+		tmp->iterationReport2 = nullptr;
+		if (program != nullptr)
+		{
+			tmp->program = new ExpressionProgram(*program);
+		}
+		return tmp;
+	}
+
+	void UnEqGroup::compileExpressions()
+	{
+		delete program;
+		program = new ExpressionProgram();
+		program->massActionKernels = massActionKernels;
+		program->usePlans = evaluationPlans;
+		for (auto uneq : uneqs)
+		{
+			uneq->equationRegister = program->addRoot(uneq->equation);
+		}
+
+		if (program->nrPrintNodes > 0)
+		{
+			// print() has no instruction, so these expressions stay in the graph
+			IO::println("The expressions contain print(), they are evaluated without a compiled program.");
+			delete program;
+			program = nullptr;
+			compiled = false;
+			return;
+		}
+		program->finish();
+
+		for (auto uneq : uneqs)
+		{
+			uneq->unknownInput = -1;
+			for (int i = 0; i < program->getNrInputs(); i++)
+			{
+				if (program->getInputVar(i) == uneq->unknown)
+				{
+					uneq->unknownInput = i;
+				}
+			}
+		}
+	}
+
+	void UnEqGroup::initBatch(int width)
+	{
+		program->initBatch(width);
+		batchWidth = width;
+		batchLaneStates.assign(width, BATCH_EMPTY);
+		batchNrIter.assign(width, 0);
+		batchUnknowns.assign(uneqs.size() * width, 0);
+		batchTargets.assign(uneqs.size() * width, 0);
+		batchTolerances.assign(uneqs.size() * width, 0);
+	}
+
+	void UnEqGroup::loadBatchLane(int lane)
+	{
+		program->loadBatchInputs(lane);
+		for (size_t k = 0; k < uneqs.size(); k++)
+		{
+			UnEq* uneq = uneqs[k];
+			size_t n = k * batchWidth + lane;
+			batchUnknowns[n] = uneq->unknown->getIniValue();
+			batchTargets[n] = uneq->equation->getIniValue();
+			double tolerance = (uneq->toleranceVariable != nullptr) ? uneq->toleranceVariable->getValue() : uneq->eq_tolerance;
+			batchTolerances[n] = tolerance * uneq->toleranceFactor;
+		}
+		batchLaneStates[lane] = BATCH_ITERATING;
+		batchNrIter[lane] = 1;
+	}
+
+	void UnEqGroup::iterateBatch(StopFlag* flag)
+	{
+		if (batchWidth == 8)
+		{
+			iterateBatch<8>(flag);
+		}
+		else if (batchWidth == 4)
+		{
+			iterateBatch<4>(flag);
+		}
+		else
+		{
+			throw OrchestraException("iterateBatch was called before initBatch");
+		}
+	}
+
+	template <int W>
+	void UnEqGroup::iterateBatch(StopFlag* flag)
+	{
+		initialise();
+		const int dim = nrActiveUneqs;
+
+		batchActive.resize(dim);
+		for (int m = 0; m < dim; m++)
+		{
+			batchActive[m] = (int)(std::find(uneqs.begin(), uneqs.end(), activeUneqs[m]) - uneqs.begin());
+		}
+		batchResiduals.resize((size_t)dim * W);
+		batchJResiduals.resize((size_t)dim * W);
+		batchJacobian.resize((size_t)dim * dim * W);
+		double* residuals = batchResiduals.data();
+
+		// the input-invariant instructions are executed once for the loaded lanes
+		bool firstRun = true;
+		while (true)
+		{
+			// the unknowns of all lanes, also the masked lanes are evaluated
+			for (int m = 0; m < dim; m++)
+			{
+				if (activeUneqs[m]->unknownInput >= 0)
+				{
+					std::copy_n(&batchUnknowns[(size_t)batchActive[m] * W], W, program->getBatchInput(activeUneqs[m]->unknownInput));
+				}
+			}
+			if (firstRun)
+			{
+				program->runBatch();
+				firstRun = false;
+			}
+			else
+			{
+				program->runBatchVariant();
+			}
+			calculateBatchResiduals<W>(residuals);
+
+			bool iterating = false;
+			for (int l = 0; l < W; l++)
+			{
+				if (batchLaneStates[l] != BATCH_ITERATING)
+				{
+					continue;
+				}
+				double convergence = 0;
+				bool nan = false;
+				for (int m = 0; m < dim; m++)
+				{
+					double residual = residuals[m * W + l];
+					nan = nan || std::isnan(residual);
+					convergence = std::max(convergence, std::abs(residual) / batchTolerances[(size_t)batchActive[m] * W + l]);
+				}
+				if (nan)
+				{
+					batchLaneStates[l] = BATCH_FAILED;
+				}
+				else if (convergence <= 1)
+				{
+					batchLaneStates[l] = BATCH_CONVERGED;
+				}
+				else
+				{
+					iterating = true;
+				}
+			}
+
+			if (iterating && (flag != nullptr) && flag->isCancelled())
+			{
+				for (auto& state : batchLaneStates)
+				{
+					if (state == BATCH_ITERATING) state = BATCH_FAILED;
+				}
+				iterating = false;
+			}
+			if (!iterating)
+			{
+				break;
+			}
+
+			calculateBatchJacobian<W>();
+			ludcmpBatch<W>(batchJacobian.data(), residuals, dim);
+			adaptBatchEstimations<W>();
+
+			for (int l = 0; l < W; l++)
+			{
+				if (batchLaneStates[l] == BATCH_ITERATING)
+				{
+					batchNrIter[l]++;
+					if (batchNrIter[l] >= maxIter)
+					{
+						batchLaneStates[l] = BATCH_FAILED;
+					}
+				}
+			}
+		}
+	}
+
+	template <int W>
+	void UnEqGroup::calculateBatchResiduals(double* residuals)
+	{
+		for (int m = 0; m < nrActiveUneqs; m++)
+		{
+			const double* value = program->getBatchValue(activeUneqs[m]->equationRegister);
+			const double* target = &batchTargets[(size_t)batchActive[m] * W];
+			for (int l = 0; l < W; l++)
+			{
+				residuals[m * W + l] = value[l] - target[l];
+			}
+		}
+	}
+
+	template <int W>
+	void UnEqGroup::calculateBatchJacobian()
+	{
+		const int dim = nrActiveUneqs;
+		double* jacobian = batchJacobian.data();
+		const double* residuals = batchResiduals.data();
+		double* jresiduals = batchJResiduals.data();
+		double delta[W];
+
+		for (int i = 0; i < dim; i++)
+		{
+			UnEq* uneq = activeUneqs[i];
+			if (uneq->unknownInput < 0)
+			{
+				// none of the equations depends on this unknown
+				for (int f = 0; f < dim; f++)
+				{
+					std::fill_n(&jacobian[((size_t)f * dim + i) * W], W, 0.0);
+				}
+				continue;
+			}
+
+			const double* unknown = &batchUnknowns[(size_t)batchActive[i] * W];
+			double* input = program->getBatchInput(uneq->unknownInput);
+			for (int l = 0; l < W; l++)
+			{
+				delta[l] = uneq->defaultDeltaUnknown(unknown[l]);
+				input[l] = uneq->offsetValue(unknown[l], delta[l]);
+			}
+			program->runBatch(uneq->unknownInput);
+			calculateBatchResiduals<W>(jresiduals);
+
+			if (centralDifferences)
+			{
+				for (int f = 0; f < dim; f++)
+				{
+					std::copy_n(&jresiduals[f * W], W, &jacobian[((size_t)f * dim + i) * W]);
+				}
+				for (int l = 0; l < W; l++)
+				{
+					input[l] = uneq->offsetValue(unknown[l], -delta[l]);
+				}
+				program->runBatch(uneq->unknownInput);
+				calculateBatchResiduals<W>(jresiduals);
+				for (int f = 0; f < dim; f++)
+				{
+					double* element = &jacobian[((size_t)f * dim + i) * W];
+					for (int l = 0; l < W; l++)
+					{
+						element[l] = (element[l] - jresiduals[f * W + l]) / (2 * delta[l]);
+					}
+				}
+			}
+			else
+			{
+				for (int f = 0; f < dim; f++)
+				{
+					double* element = &jacobian[((size_t)f * dim + i) * W];
+					for (int l = 0; l < W; l++)
+					{
+						element[l] = (jresiduals[f * W + l] - residuals[f * W + l]) / delta[l];
+					}
+				}
+			}
+
+			// reset the unknown, the next column only executes the instructions that depend on its own unknown
+			std::copy_n(unknown, W, input);
+			if (i < dim - 1)
+			{
+				program->runBatch(uneq->unknownInput);
+			}
+		}
+	}
+
+	template <int W>
+	void UnEqGroup::adaptBatchEstimations()
+	{
+		const int dim = nrActiveUneqs;
+		const double* steps = batchResiduals.data();  // the solution of the linear system
+		const double minimumfactor = 1e-5;
+		double common[W];
+		std::fill_n(common, W, 1.0);
+
+		// the common factor per lane, as in adaptEstimations
+		batchJResiduals.resize((size_t)dim * W);
+		double* factors = batchJResiduals.data();
+		for (int m = 0; m < dim; m++)
+		{
+			const double* unknown = &batchUnknowns[(size_t)batchActive[m] * W];
+			for (int l = 0; l < W; l++)
+			{
+				double factor = activeUneqs[m]->stepFactor(unknown[l], steps[m * W + l]);
+				factors[m * W + l] = factor;
+				if ((factor > minimumfactor) && (factor < common[l]))
+				{
+					common[l] = factor;
+				}
+			}
+		}
+
+		for (int m = 0; m < dim; m++)
+		{
+			double* unknown = &batchUnknowns[(size_t)batchActive[m] * W];
+			for (int l = 0; l < W; l++)
+			{
+				if (batchLaneStates[l] != BATCH_ITERATING)
+				{
+					continue; // masked
+				}
+				double factor = (factors[m * W + l] < common[l]) ? factors[m * W + l] : common[l];
+				unknown[l] = activeUneqs[m]->offsetValue(unknown[l], -steps[m * W + l] * factor);
+			}
+		}
+	}
+
+	template <int W>
+	void UnEqGroup::ludcmpBatch(double* a, double* b, int dim)
+	{
+		batchScale.resize((size_t)dim * W);
+		batchPivots.resize((size_t)dim * W);
+		double* vv = batchScale.data();
+		int* indx = batchPivots.data();
+		double big[W];
+		int imax[W];
+
+		// element (i, j) of lane l
+		auto at = [a, dim](int i, int j) { return &a[((size_t)i * dim + j) * W]; };
+
+		for (int i = 0; i < dim; i++)
+		{
+			std::fill_n(big, W, 0.0);
+			for (int j = 0; j < dim; j++)
+			{
+				const double* element = at(i, j);
+				for (int l = 0; l < W; l++)
+				{
+					double temp = std::abs(element[l]);
+					big[l] = (temp > big[l]) ? temp : big[l];
+				}
+			}
+			for (int l = 0; l < W; l++)
+			{
+				if ((big[l] == 0.0) && (batchLaneStates[l] == BATCH_ITERATING))
+				{
+					batchLaneStates[l] = BATCH_FAILED; // singular, left to the scalar iteration
+				}
+				vv[i * W + l] = 1.0 / big[l];
+			}
+		}
+
+		for (int j = 0; j < dim; j++)
+		{
+			for (int i = 0; i < j; i++)
+			{
+				double* element = at(i, j);
+				for (int k = 0; k < i; k++)
+				{
+					const double* left = at(i, k);
+					const double* right = at(k, j);
+					for (int l = 0; l < W; l++) element[l] -= left[l] * right[l];
+				}
+			}
+
+			std::fill_n(big, W, 0.0);
+			std::fill_n(imax, W, 0);
+			for (int i = j; i < dim; i++)
+			{
+				double* element = at(i, j);
+				for (int k = 0; k < j; k++)
+				{
+					const double* left = at(i, k);
+					const double* right = at(k, j);
+					for (int l = 0; l < W; l++) element[l] -= left[l] * right[l];
+				}
+				for (int l = 0; l < W; l++)
+				{
+					double dum = vv[i * W + l] * std::abs(element[l]);
+					if (dum >= big[l])
+					{
+						big[l] = dum;
+						imax[l] = i;
+					}
+				}
+			}
+
+			for (int l = 0; l < W; l++)
+			{
+				if (j != imax[l])
+				{
+					// each lane swaps its own rows
+					for (int c = 0; c < dim; c++)
+					{
+						std::swap(at(imax[l], c)[l], at(j, c)[l]);
+					}
+					vv[imax[l] * W + l] = vv[j * W + l];
+				}
+				indx[j * W + l] = imax[l];
+			}
+
+			double* pivot = at(j, j);
+			for (int l = 0; l < W; l++)
+			{
+				if (pivot[l] == 0.0)
+				{
+					pivot[l] = 1e-30;
+				}
+			}
+
+			if (j != dim - 1)
+			{
+				double dum[W];
+				for (int l = 0; l < W; l++) dum[l] = 1.0 / pivot[l];
+				for (int i = j + 1; i < dim; i++)
+				{
+					double* element = at(i, j);
+					for (int l = 0; l < W; l++) element[l] *= dum[l];
+				}
+			}
+		}
+
+		// the leading zeros of b that lubksb skips contribute nothing to the sums
+		for (int i = 0; i < dim; i++)
+		{
+			double* sum = &b[i * W];
+			for (int l = 0; l < W; l++)
+			{
+				int ip = indx[i * W + l];
+				double value = b[ip * W + l];
+				b[ip * W + l] = sum[l];
+				sum[l] = value;
+			}
+			for (int j = 0; j < i; j++)
+			{
+				const double* element = at(i, j);
+				for (int l = 0; l < W; l++) sum[l] -= element[l] * b[j * W + l];
+			}
+		}
+
+		for (int i = dim - 1; i >= 0; i--)
+		{
+			double* sum = &b[i * W];
+			for (int j = i + 1; j < dim; j++)
+			{
+				const double* element = at(i, j);
+				for (int l = 0; l < W; l++) sum[l] -= element[l] * b[j * W + l];
+			}
+			const double* pivot = at(i, i);
+			for (int l = 0; l < W; l++) sum[l] = sum[l] / pivot[l];
+		}
+	}
+
 	/**
      * This method is called AFTER all uneqs are added. and BEFORE each level1
      * iteration. It dimensions the jacobian arrays according to the number of
@@ -110,6 +593,10 @@ namespace orchestracpp
 				tolerance->setConstant(false);
 			}
 		}
+
+		// the set of active uneqs may have changed, so the stored jacobian cannot be used anymore
+		fullJacobianValid = false;
+		lastStepWasSubspace = false;
 	}
 
 	UnEq *UnEqGroup::doesExist(UnEq *u) //throw(ReadException)
@@ -205,10 +692,7 @@ namespace orchestracpp
 	{
 		for (auto u : uneqs) {
 			if (u->initiallyInactive) {
-				if (!u->active) {
-					IO::println("Switching on: " + u->unknown->name + ": " + StringHelper::toString(u->unknown->getIniValue()));
-					u->active = true;
-				}
+				u->active = true;
 			}
 		}
 	}
@@ -217,14 +701,18 @@ namespace orchestracpp
 	{
 		for (auto u : uneqs) {
 			if (u->initiallyInactive) {
-				if (u->active) {
-					IO::println("Switching off: " + u->unknown->name + ": " + StringHelper::toString(u->unknown->getIniValue()));
-					u->active = false;
-				}
+				u->active = false;
 			}
 		}
 	}
 
+	void UnEqGroup::setToleranceFactor(double factor)
+	{
+		for (auto u : uneqs) {
+			u->toleranceFactor = factor;
+		}
+	}
+
 	void UnEqGroup::iterateLevelMinerals(StopFlag *flag)// throw(IOException)
 	{
 		if (monitor)
@@ -305,7 +793,7 @@ namespace orchestracpp
 
 			if (flag != nullptr)
 			{
-				if (flag->cancelled)
+				if (flag->isCancelled())
 				{
 					break;
 				}
@@ -350,16 +838,40 @@ namespace orchestracpp
 
 	}
 
+	void UnEqGroup::selectPlan()
+	{
+		if (program == nullptr)
+		{
+			return;
+		}
+		planEquations.clear();
+		for (int m = 0; m < nrActiveUneqs; m++)
+		{
+			planEquations.push_back(activeUneqs[m]->equationRegister);
+		}
+		program->selectPlan(planEquations);
+	}
+
 	int UnEqGroup::iterateLevel0(StopFlag *flag)
 	{
 		int nrIter0 = 1;
 		initialise();
+		selectPlan();
 		// Here we create the actual matrix of active uneqs that        
 		// is used during the iteration 
 
 		try
 		{
 			nrIter0 = 1;
+			useCentralDifferences = centralDifferences;
+			if (adaptiveDelta)
+			{
+				// the curvature of the previous node does not apply to this one
+				for (auto uneq : uneqs)
+				{
+					uneq->resetCurvature();
+				}
+			}
 
 			if (nrActiveUneqs == 0)
 			{
@@ -380,15 +892,29 @@ namespace orchestracpp
 						writeIterationReportLine2(nrIter0);
 					}
 
-					calculateJacobian();
-					adaptEstimations();
+					if (!(subspaceNewton && subspaceNewtonStep(howConvergent_field)))
+					{
+						calculateJacobian();
+						if (subspaceNewton)
+						{
+							fullJacobian.assign(jacobian5, jacobian5 + nrActiveUneqs * nrActiveUneqs);
+							fullJacobianValid = true;
+						}
+						adaptEstimations();
+					}
 
 					nrIter0++;
 					totalNrIter++;
 
+					if (adaptiveDelta && (nrIter0 > maxIter / 2))
+					{
+						// we are getting close to failing, so use more accurate derivatives
+						useCentralDifferences = true;
+					}
+
 					if (flag != nullptr)
 					{
-						if (flag->cancelled)
+						if (flag->isCancelled())
 						{ 
 							nrIter0 = maxIter;
 							break;
@@ -555,35 +1081,221 @@ namespace orchestracpp
     }
     
 
+	bool UnEqGroup::calculateAnalyticJacobian()
+		{
+			if (!analyticJacobian || (program == nullptr))
+			{
+				return false;
+			}
+
+			// the active uneqs change with the minerals and subspace steps
+			if (!std::equal(activeUneqs.begin(), activeUneqs.begin() + nrActiveUneqs, jacobianUneqs.begin(), jacobianUneqs.end()))
+			{
+				jacobianUneqs.assign(activeUneqs.begin(), activeUneqs.begin() + nrActiveUneqs);
+				std::vector<int> equations;
+				std::vector<int> unknowns;
+				std::vector<bool> logarithmic;
+				jacobianIsAnalytic = true;
+				for (UnEq* uneq : jacobianUneqs)
+				{
+					jacobianIsAnalytic = jacobianIsAnalytic && (uneq->unknownInput >= 0);
+					equations.push_back(uneq->equationRegister);
+					unknowns.push_back(uneq->unknownInput);
+					logarithmic.push_back(uneq->un_type == uneq->log);
+				}
+				jacobianIsAnalytic = jacobianIsAnalytic && program->prepareJacobian(equations, unknowns, logarithmic);
+			}
+			if (!jacobianIsAnalytic)
+			{
+				return false;
+			}
+
+			// the registers hold the values at the central point (howConvergent)
+			program->calculateJacobian(jacobian5);
+			return true;
+		}
+
 	void UnEqGroup::calculateJacobian()// throw(OrchestraException)
 		{
+			if (calculateAnalyticJacobian())
+			{
+				return;
+			}
+
+			// Without a compiled program the expressions are evaluated in the graph. Restoring the
+			// central state after each column avoids re-evaluating everything that depends on the previous unknown.
+			// The compiled program restores the central registers of the previous unknown in the same way.
+			bool restoreCentralState = (program == nullptr) && !variables->state.registers.empty();
+			if (restoreCentralState)
+			{
+				variables->saveState(centralState);
+			}
+			else if (program != nullptr)
+			{
+				program->saveCentral();
+			}
 
 			for (int i = 0; i < nrActiveUneqs; i++)
 			{
 
 				// store the original unknown value
 				// and offset the unknown value input
+				activeUneqs[i]->centralDelta = useCentralDifferences;
 				double originalUnknownValue = activeUneqs[i]->offsetUnknown();
 
 				// calculate the residuals for the offset of this unknown
-			    for (int m = 0; m < nrActiveUneqs; m++) {
-			        activeUneqs[m]->calculateJResidual();
-			    }
+				calculateJResiduals();
+
+				if (useCentralDifferences)
+				{
+					// store the forward residuals and calculate the backward ones
+					for (int fnr = 0; fnr < nrActiveUneqs; fnr++)
+					{
+						jacobian5[nrActiveUneqs * fnr + i] = activeUneqs[fnr]->jacobianResidual;
+					}
+
+					activeUneqs[i]->offsetUnknown(originalUnknownValue, -activeUneqs[i]->un_delta);
+					calculateJResiduals();
+					activeUneqs[i]->resetUnknown(originalUnknownValue);
+					if (restoreCentralState)
+					{
+						variables->restoreState(centralState);
+					}
+					else if (program != nullptr)
+					{
+						program->restoreCentral(activeUneqs[i]->unknownInput);
+					}
 
-				// reset the unknown to original value
-				activeUneqs[i]->resetUnknown(originalUnknownValue);
+					for (int fnr = 0; fnr < nrActiveUneqs; fnr++)
+					{
+						jacobian5[nrActiveUneqs * fnr + i] = (jacobian5[nrActiveUneqs * fnr + i] - activeUneqs[fnr]->jacobianResidual) / (2 * activeUneqs[i]->un_delta);
+					}
+				}
+				else
+				{
+					// reset the unknown to original value
+					activeUneqs[i]->resetUnknown(originalUnknownValue);
+					if (restoreCentralState)
+					{
+						variables->restoreState(centralState);
+					}
+					else if (program != nullptr)
+					{
+						program->restoreCentral(activeUneqs[i]->unknownInput);
+					}
+
+					// calculate the jacobian values from the residuals
+					for (int fnr = 0; fnr < nrActiveUneqs; fnr++)
+					{
+						//jacobian2[fnr][i] = (activeUneqs[fnr]->jacobianResidual - activeUneqs[fnr]->centralResidual) / activeUneqs[i]->un_delta;
+						jacobian5[nrActiveUneqs * fnr + i] = (activeUneqs[fnr]->jacobianResidual - activeUneqs[fnr]->centralResidual) / activeUneqs[i]->un_delta;
+					}
+				}
 
-				// calculate the jacobian values from the residuals
-				for (int fnr = 0; fnr < nrActiveUneqs; fnr++)
+				if (adaptiveDelta)
 				{
-					//jacobian2[fnr][i] = (activeUneqs[fnr]->jacobianResidual - activeUneqs[fnr]->centralResidual) / activeUneqs[i]->un_delta;
-					jacobian5[nrActiveUneqs * fnr + i] = (activeUneqs[fnr]->jacobianResidual - activeUneqs[fnr]->centralResidual) / activeUneqs[i]->un_delta;
+					activeUneqs[i]->updateCurvature(jacobian5[nrActiveUneqs * i + i]);
 				}
 			}
 
 		}
 
 
+		bool UnEqGroup::subspaceNewtonStep(double convergence)
+		{
+			// if the previous subspace step made things worse, do a full step
+			if (lastStepWasSubspace && (convergence > convergenceBeforeSubspaceStep))
+			{
+				lastStepWasSubspace = false;
+				return false;
+			}
+			lastStepWasSubspace = false;
+
+			// the analytic jacobian of all active uneqs costs little more than that of a subspace, and
+			// it would have to be prepared again for every subspace, so only full steps are used then
+			if (!fullJacobianValid || jacobianIsAnalytic)
+			{
+				return false;
+			}
+
+			// the uneqs that are not convergent yet, these already have a calculated central residual
+			std::vector<bool> inSubspace(nrActiveUneqs, false);
+			int nrNotConvergent = 0;
+			for (int m = 0; m < nrActiveUneqs; m++)
+			{
+				if (activeUneqs[m]->convergence(activeUneqs[m]->centralResidual) > 1)
+				{
+					inSubspace[m] = true;
+					nrNotConvergent++;
+				}
+			}
+
+			if ((nrNotConvergent == 0) || (nrNotConvergent > subspaceFraction * nrActiveUneqs))
+			{
+				return false;
+			}
+
+			// add the strongly coupled neighbours:
+			// unknowns that have a large effect on a non-convergent equation, and
+			// equations that depend strongly on a non-convergent unknown
+			std::vector<bool> coupled(inSubspace);
+			for (int f = 0; f < nrActiveUneqs; f++)
+			{
+				double rowMax = 0;
+				for (int i = 0; i < nrActiveUneqs; i++)
+				{
+					rowMax = std::max(rowMax, std::abs(fullJacobian[nrActiveUneqs * f + i]));
+				}
+				double threshold = couplingThreshold * rowMax;
+
+				for (int i = 0; i < nrActiveUneqs; i++)
+				{
+					if (std::abs(fullJacobian[nrActiveUneqs * f + i]) >= threshold)
+					{
+						if (inSubspace[f])
+						{
+							coupled[i] = true;
+						}
+						if (inSubspace[i])
+						{
+							coupled[f] = true;
+						}
+					}
+				}
+			}
+
+			subspaceUneqs.clear();
+			for (int m = 0; m < nrActiveUneqs; m++)
+			{
+				if (coupled[m])
+				{
+					subspaceUneqs.push_back(activeUneqs[m]);
+				}
+			}
+
+			if ((int)subspaceUneqs.size() >= nrActiveUneqs)
+			{
+				return false;
+			}
+
+			// Calculate the jacobian and new estimations for the subspace only.
+			// The other unknowns keep their values, the full residual is checked in the next iteration.
+			int fullDim = nrActiveUneqs;
+			std::vector<UnEq*> allActiveUneqs(activeUneqs.begin(), activeUneqs.begin() + fullDim);
+			std::copy(subspaceUneqs.begin(), subspaceUneqs.end(), activeUneqs.begin());
+			nrActiveUneqs = subspaceUneqs.size();
+
+			calculateJacobian();
+			adaptEstimations();
+
+			std::copy(allActiveUneqs.begin(), allActiveUneqs.end(), activeUneqs.begin());
+			nrActiveUneqs = fullDim;
+
+			lastStepWasSubspace = true;
+			convergenceBeforeSubspaceStep = convergence;
+			return true;
+		}
+
 	    void UnEqGroup::printJacobian() {
 			if (jacprinted) {
 				return;
@@ -658,15 +1370,47 @@ namespace orchestracpp
 
 			double convergence = 0;
 
+			if (program != nullptr)
+			{
+				program->run();
+			}
+
 			for (int m = 0; m < nrActiveUneqs; m++)
 			{
-				activeUneqs[m]->calculateCentralResidual();
-				convergence = std::max(convergence, activeUneqs[m]->howConvergent());
+				UnEq* uneq = activeUneqs[m];
+				if (program != nullptr)
+				{
+					uneq->centralResidual = program->getValue(uneq->equationRegister) - uneq->equation->getIniValue();
+				}
+				else
+				{
+					uneq->calculateCentralResidual();
+				}
+				convergence = std::max(convergence, uneq->convergence(uneq->centralResidual));
 			}
 
 			return (convergence);
 		}
 
+		void UnEqGroup::calculateJResiduals()// throw(OrchestraException)
+		{
+			if (program == nullptr)
+			{
+				for (int m = 0; m < nrActiveUneqs; m++)
+				{
+					activeUneqs[m]->calculateJResidual();
+				}
+				return;
+			}
+
+			program->run();
+			for (int m = 0; m < nrActiveUneqs; m++)
+			{
+				UnEq* uneq = activeUneqs[m];
+				uneq->jacobianResidual = program->getValue(uneq->equationRegister) - uneq->equation->getIniValue();
+			}
+		}
+
 
 
 		void UnEqGroup::ludcmp_plus_lubksb_new(double* jac2, int const dim)
@@ -8,6 +8,7 @@
 #include "OrchestraReader.h"
 #include "UnEq.h"
 #include "StopFlag.h"
+#include "ExpressionProgram.h"
 #include "OrchestraException.h"
 //#include "
 
@@ -66,10 +67,17 @@ namespace orchestracpp
 					delete iterationReport;
 				}
 				delete []jacobian5;
+				delete program;
 			}
 
 			UnEqGroup(VarGroup *variables);
 
+			/**
+			 * Returns a copy with its own uneqs, jacobian and compiled program registers,
+			 * that uses the same variables.
+			 */
+			UnEqGroup* clone();
+
 			/**
 			 * This method is called AFTER all uneqs are added. and BEFORE each level1
 			 * iteration. It dimensions the jacobian arrays according to the number of
@@ -104,8 +112,82 @@ namespace orchestracpp
 
 			void switchOffIIA();
 
+			// multiply the tolerances of all uneqs with this factor (1 = use the tolerances from the input file)
+			void setToleranceFactor(double factor);
+
 			int maxMineralIterations = 100; // shall we increase this?
 
+			/**
+			 * Subspace Newton: when only a few uneqs are not yet convergent, the Newton
+			 * correction is calculated for these uneqs and their strongly coupled
+			 * neighbours only. The other unknowns are kept constant during that step.
+			 * Switched on with the @subspacenewton: keyword, not used when the jacobian is analytic.
+			 */
+			bool subspaceNewton = false;
+			double subspaceFraction = 0.25;  // max fraction of non-convergent uneqs to use a subspace step
+			double couplingThreshold = 0.1;  // relative jacobian value above which two uneqs are strongly coupled
+
+			/**
+			 * Adaptive delta: each uneq determines its delta unknown from the curvature of its
+			 * equation observed between iterations (@adaptivedelta: keyword). Central differences
+			 * are then used when the iteration gets close to failing (more than half of maxIter).
+			 */
+			bool adaptiveDelta = false;
+			bool centralDifferences = false; // always use central differences for the jacobian
+
+			/**
+			 * The equations are evaluated with a compiled expression program instead of
+			 * the expression graph, unless switched off with the @nocompile: keyword.
+			 */
+			bool compiled = true;
+			bool nativeCode = false; // translate the program to C++ and load it as shared library (@nativecode:)
+			bool fastMath = false;   // use the FastMath kernels instead of the standard library (@fastmath:)
+			bool massActionKernels = true; // fuse the exponentials into mass action kernels, switched off with @nomassaction:
+			ExpressionProgram* program = nullptr;
+
+			/**
+			 * Analytic jacobian (@analyticjacobian:): the compiled program differentiates the equations
+			 * through its mass balance and mass action kernels, instead of offsetting each unknown.
+			 * Falls back to finite differences if an equation contains an instruction that is not
+			 * differentiated by the program. Not used in the batch iteration.
+			 */
+			bool analyticJacobian = false;
+
+			/**
+			 * The iteration of the active uneqs evaluates only what their equations depend on,
+			 * with an evaluation plan of the compiled program per set of active uneqs and
+			 * if node conditions. Switched off with @noplans:.
+			 */
+			bool evaluationPlans = true;
+
+			/**
+			 * Compile the (optimized) expressions of all equations into the expression program.
+			 * Expressions with print() are not compiled, program is then nullptr.
+			 */
+			void compileExpressions();
+
+			/**
+			 * Lockstep Newton iteration of a batch of nodes (Calculator::calculateBatch).
+			 * Each lane of the compiled program in batch mode holds one node, all lanes share
+			 * the active uneqs. A lane is masked when it has converged, and fails when it gives
+			 * a NaN or a singular jacobian or reaches maxIter, failed lanes are left to the scalar
+			 * iteration. The batch iteration uses the default delta unknowns and full Newton steps,
+			 * also when adaptive delta or subspace Newton are switched on.
+			 */
+			enum BatchLaneState { BATCH_EMPTY, BATCH_ITERATING, BATCH_CONVERGED, BATCH_FAILED };
+			std::vector<BatchLaneState> batchLaneStates;
+
+			void initBatch(int width);
+
+			int getBatchWidth() { return batchWidth; }
+
+			// load the current variable values into this lane, the lane starts iterating
+			void loadBatchLane(int lane);
+
+			void iterateBatch(StopFlag* flag);
+
+			inline double getBatchUnknown(int uneq, int lane) { return batchUnknowns[(size_t)uneq * batchWidth + lane]; }
+
 
 			/**
 			 * Here we iterate for the presence of minerals
@@ -118,8 +200,50 @@ namespace orchestracpp
 			double howConvergent_field = 0;
 
 		private:
+			bool useCentralDifferences = false;
+			std::vector<UnEq*> jacobianUneqs;  // the active uneqs for which the analytic jacobian was prepared
+			bool jacobianIsAnalytic = false;
+			bool calculateAnalyticJacobian();
+			std::vector<int> planEquations;
+			void selectPlan();
+			VarGroupState centralState;  // the evaluation state at the central point, restored after each jacobian column
+			std::vector<double> fullJacobian;  // copy of the last complete jacobian, used to find coupled uneqs
+			bool fullJacobianValid = false;
+			std::vector<UnEq*> subspaceUneqs;
+			bool lastStepWasSubspace = false;
+			double convergenceBeforeSubspaceStep = 0;
+
 			int iterateLevel0(StopFlag *flag);
 
+			int batchWidth = 0;
+			std::vector<double> batchUnknowns;   // uneq major, one lane per node
+			std::vector<double> batchTargets;    // ini values of the equations
+			std::vector<double> batchTolerances;
+			std::vector<int> batchNrIter;
+			std::vector<int> batchActive;        // index in uneqs of each active uneq
+			std::vector<double> batchResiduals;  // active uneq major
+			std::vector<double> batchJResiduals;
+			std::vector<double> batchJacobian;   // interleaved, element (f, i) of lane l at (f * dim + i) * width + l
+			std::vector<double> batchScale;
+			std::vector<int> batchPivots;
+
+			template <int W> void iterateBatch(StopFlag* flag);
+			template <int W> void calculateBatchResiduals(double* residuals);
+			template <int W> void calculateBatchJacobian();
+			template <int W> void adaptBatchEstimations();
+
+			/**
+			 * The LU decomposition and back substitution of ludcmp_plus_lubksb_new for W
+			 * interleaved matrices, each lane with its own pivoting. The solution replaces b.
+			 */
+			template <int W> void ludcmpBatch(double* jacobian, double* b, int dim);
+
+			/**
+			 * Carry out a Newton step for the non-convergent uneqs and their strongly coupled
+			 * neighbours only. Returns false if a full Newton step is required instead.
+			 */
+			bool subspaceNewtonStep(double convergence);
+
 			/**
 			 * This method is called when the iteration has failed, and was restarted to
 			 * generate an iteration report. This method writes the header of this
@@ -129,6 +253,11 @@ namespace orchestracpp
 			 * @throws IOException
 			 */
 			void initialiseIterationReport() /*throw(IOException)*/;
+
+			/**
+			 * Calculate the jacobian residuals of all active uneqs for the current unknown values.
+			 */
+			void calculateJResiduals() /*throw(OrchestraException)*/;
 			void initialiseIterationReport2() /*throw(IOException)*/;
 
 			/**
@@ -4,6 +4,7 @@
 #include "OrchestraReader.h"
 #include "OrchestraException.h"
 #include "Parser.h"
+#include <algorithm>
 
 
 namespace orchestracpp
@@ -14,7 +15,7 @@ namespace orchestracpp
 		try
 		{
 			name  = in->readWord();
-			value = in->readDouble();
+			ownValue = in->readDouble();
 		}
 		catch (const ReadException &re)
 		{
@@ -34,7 +35,7 @@ namespace orchestracpp
 	Var::Var(const std::string &n, double i)
 	{
 		name = n;
-		value = i;
+		ownValue = i;
 	}
 
 	Var::Var(const std::string &n) : Var(n, 1.111111111e-111)
@@ -43,19 +44,29 @@ namespace orchestracpp
 
 	void Var::setValue(double value)
 	{
-		if (this->value == value)
+		double& current = (reg < 0) ? ownValue : VarGroupState::currentRegisters[reg];
+		if (current == value)
 		{
 			return; // value was not changed
 		}
 
-		this->value = value;
+		current = value;
 
 //		for (auto n : newDependentMemoryNodes) {
 //			n->needsEvaluation = true;
 //		}
 
+		if (useDependentMemoryNodeBits)
+		{
+			uint64_t* dirtyMemoryNodes = VarGroupState::currentDirtyMemoryNodes;
+			for (auto& bits : dependentMemoryNodeBits) {
+				dirtyMemoryNodes[bits.first] |= bits.second;
+			}
+			return;
+		}
+
 		for (auto n : dependentMemoryNodes) {
-			n->needsEvaluation = true;
+			n->invalidate();
 		}
 
 
@@ -65,7 +76,7 @@ namespace orchestracpp
 	{
 		if (memory == nullptr)
 		{
-			return value;
+			return (reg < 0) ? ownValue : VarGroupState::currentRegisters[reg];
 		}
 		else
 		{
@@ -75,7 +86,7 @@ namespace orchestracpp
 
 	double Var::getIniValue()
 	{
-		return value;
+		return (reg < 0) ? ownValue : VarGroupState::currentRegisters[reg];
 	}
 
 	void Var::setConstant(bool flag)
@@ -85,7 +96,7 @@ namespace orchestracpp
 
 	double Var::evaluate()
 	{
-		return value;
+		return (reg < 0) ? ownValue : VarGroupState::currentRegisters[reg];
 	}
 
 	bool Var::constant()
@@ -128,6 +139,26 @@ namespace orchestracpp
 //		// this is not necessary in C++
 //	}
 
+	int Var::compile(ExpressionProgram* program)
+	{
+		return program->addInput(this);
+	}
+
+	void Var::getChildren(std::vector<ExpressionNode**>& /*children*/)
+	{
+	}
+
+	ExpressionNode* Var::copy(Parser* /*parser*/)
+	{
+		return this;
+	}
+
+	void Var::setRegister(int reg, VarGroupState& state)
+	{
+		state.registers[reg] = ownValue;
+		this->reg = reg;
+	}
+
 	void Var::optimizeExpression(Parser* parser)
 	{
 		if (memory != nullptr)
@@ -138,11 +169,43 @@ namespace orchestracpp
 		}
 	}
 
-	void Var::setDependentMemoryNodes()
+	void Var::setDependentMemoryNodes(std::vector<MemoryNode*>* topologicalOrder)
 	{
 		if (memory != nullptr)
 		{
+			if (memory->topologicalOrder == nullptr)
+			{
+				memory->topologicalOrder = topologicalOrder;
+			}
 			memory->child->setDependentMemoryNode(memory);
+			memory->setId();
+		}
+	}
+
+	void Var::setDependentMemoryNodeBits()
+	{
+		dependentMemoryNodeBits.clear();
+		useDependentMemoryNodeBits = false;
+
+		std::vector<int> ids;
+		for (auto n : dependentMemoryNodes) {
+			if (n->id < 0) {
+				return; // not numbered, keep using the set
+			}
+			ids.push_back(n->id);
+		}
+		std::sort(ids.begin(), ids.end());
+
+		for (int id : ids) {
+			int word = id / 64;
+			uint64_t bit = (uint64_t)1 << (id % 64);
+			if (dependentMemoryNodeBits.empty() || (dependentMemoryNodeBits.back().first != word)) {
+				dependentMemoryNodeBits.push_back(std::make_pair(word, bit));
+			}
+			else {
+				dependentMemoryNodeBits.back().second |= bit;
+			}
 		}
+		useDependentMemoryNodeBits = true;
 	}
 }
@@ -3,9 +3,12 @@
 #include "ExpressionNode.h"
 #include <string>
 #include <unordered_set>
+#include <vector>
+#include <cstdint>
 #include "OrchestraException.h"
 #include "OrchestraReader.h"
 #include "MemoryNode.h"
+#include "VarGroupState.h"
 #include "Parser.h" 
 
 namespace orchestracpp
@@ -22,12 +25,18 @@ namespace orchestracpp
 	{
 
 	private:
-		double value = 0;
+		// Until the register file of the VarGroup is created the value is stored in the variable itself
+		double ownValue = 0;
+		int reg = -1; // index in the register file
 	public:
 		MemoryNode *memory = nullptr;
 	//	std::vector<MemoryNode*> newDependentMemoryNodes;
 		// a set automatically prevents duplicate values
 		std::unordered_set<MemoryNode*> dependentMemoryNodes;
+
+		// the same dependent memory nodes as (word index, bit mask) pairs in the dirty bitset of the VarGroup
+		std::vector<std::pair<int, uint64_t>> dependentMemoryNodeBits;
+		bool useDependentMemoryNodeBits = false;
 		
 	public:   
 		std::string name;
@@ -37,6 +46,7 @@ namespace orchestracpp
 		bool usedForIO  = false; // this variable is used for IO between cell and calculator
 
 		bool immutable = false;
+		bool parameter = false; // a constant that can be changed after optimization (@parameter:), so it is not folded
 	
 		bool usedAsExpressionResult = false;
 		// public boolean usedAsExpressionInput  = false;
@@ -90,11 +100,33 @@ namespace orchestracpp
 		 */
 		void setDependentMemoryNode(MemoryNode *dependentMemoryNode) override;
 
+		/**
+		 * In a compiled program a variable is an input register, that is loaded
+		 * with the value of this variable at the start of each run
+		 */
+		int compile(ExpressionProgram* program) override;
+
+		void getChildren(std::vector<ExpressionNode**>& children) override;
+
+		// variables are not part of the node storage, so they are not copied
+		ExpressionNode* copy(Parser* parser) override;
+
 		//virtual void initializeDependentMemoryNodesArray();
 
 		virtual void optimizeExpression(Parser* parser);
 
-		virtual void setDependentMemoryNodes();
+		virtual void setDependentMemoryNodes(std::vector<MemoryNode*>* topologicalOrder);
+
+		/**
+		 * Converts the set of dependent memory nodes into a sorted list of bitset words,
+		 * so invalidation becomes a few word-wide ORs.
+		 */
+		virtual void setDependentMemoryNodeBits();
+
+		/**
+		 * Move the value of this variable to a register in the register file of the VarGroup.
+		 */
+		void setRegister(int reg, VarGroupState& state);
 
 	};
 
@@ -3,6 +3,7 @@
 #include "Var.h"
 #include "OrchestraReader.h"
 #include "IO.h"
+#include <cstring>
 
 namespace orchestracpp
 {
@@ -49,9 +50,11 @@ namespace orchestracpp
 		synonyms.emplace(synonym, variableName);
 	}
 
-	Var* VarGroup::get(const std::string &name)
+	Var* VarGroup::get(std::string_view name)
 	{
-		return variableIndx[name];
+		// find does not add an empty entry for names that are not found
+		auto found = variableIndx.find(name);
+		return (found == variableIndx.end()) ? nullptr : found->second;
 	}
 
 	// in contrast with the java version we do not create a new vector here 
@@ -72,9 +75,7 @@ namespace orchestracpp
 			v->optimizeExpression(parser);
 		}
 
-		setDependentMemoryNodes();
-
-		// We now have all expressions optimized and dpendent memory nodes set
+		// We now have all expressions optimized
 		// To optimize specifically this C++ version we replace a series of connected
 		// PlusNodes by a single MultiPlusNode. This reduces the number of virtual method pointers that
 		// have to be looked up in memory by ca 50%, and  reduces overall runtime by ca 25%
@@ -92,7 +93,7 @@ namespace orchestracpp
 				    if (plusNodes->size() >= 2) {
 
 						// now we replace the original PlusNode pointer of this variable to the new MultiPlusNode 
-					    v->memory->child = new MultiPlusNode(plusNodes, (PlusNode*)v->memory->child);
+					    v->memory->child = parser->newNode(new (parser) MultiPlusNode(plusNodes, (PlusNode*)v->memory->child));
 				    }
 					// and we can delete the plusNodes as these are only used during intialisation
 					// delete(plusNodes);
@@ -105,23 +106,71 @@ namespace orchestracpp
         }
 		//*/
 
+		// The nodes that are still used are moved together into a new node storage, in evaluation order,
+		// the nodes that were removed by the optimization are deleted
+		std::vector<Var*> roots;
+		for (auto v : variables) {
+			if (v->memory != nullptr) {
+				roots.push_back(v);
+			}
+		}
+		parser->compact(roots);
+
+		setDependentMemoryNodes();
 	}
 
 	void VarGroup::setDependentMemoryNodes() {
 		for (auto v : variables) {
 			if (!v->constant()) {
 				if (v->memory != nullptr) {
-					v->setDependentMemoryNodes();
+					v->setDependentMemoryNodes(&memoryNodes);
 				}
 			}
 		}
 
+		// The memory nodes are now numbered in topological order, their dirty flags
+		// are moved into a single bitset, that is invalidated word-wise by the variables.
+		// All values are moved into one register file.
+		state.dirtyMemoryNodes.assign((memoryNodes.size() + 63) / 64, 0);
+		state.registers.assign(variables.size() + memoryNodes.size(), 0.0);
+		int reg = 0;
+		for (auto v : variables) {
+			v->setRegister(reg++, state);
+		}
+		for (size_t n = 0; n < memoryNodes.size(); n++) {
+			memoryNodes[n]->setRegister(reg++, (int)(n / 64), (uint64_t)1 << (n % 64), state);
+		}
+		for (auto v : variables) {
+			v->setDependentMemoryNodeBits();
+		}
+		state.makeCurrent();
+
 // not necessary in C++
 //		for (auto v : variables) {
 //			v->initializeDependentMemoryNodesArray();
 //		}
 	}
 
+	void VarGroup::saveState(VarGroupState& copy) {
+		copy.registers.resize(state.registers.size());
+		copy.dirtyMemoryNodes.resize(state.dirtyMemoryNodes.size());
+		std::memcpy(copy.registers.data(), VarGroupState::currentRegisters, copy.registers.size() * sizeof(double));
+		std::memcpy(copy.dirtyMemoryNodes.data(), VarGroupState::currentDirtyMemoryNodes, copy.dirtyMemoryNodes.size() * sizeof(uint64_t));
+	}
+
+	void VarGroup::restoreState(const VarGroupState& copy) {
+		std::memcpy(VarGroupState::currentRegisters, copy.registers.data(), copy.registers.size() * sizeof(double));
+		std::memcpy(VarGroupState::currentDirtyMemoryNodes, copy.dirtyMemoryNodes.data(), copy.dirtyMemoryNodes.size() * sizeof(uint64_t));
+	}
+
+	void VarGroup::evaluateConstants() {
+		for (auto v : variables) {
+			if (v->constant() && (v->memory != nullptr)) {
+				v->getValue();
+			}
+		}
+	}
+
 //	void VarGroup::initializeParentsArrays()
 //	{
 		// not necessary in c++
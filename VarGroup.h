@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <map>
 #include <unordered_map>
 #include <unordered_set>
@@ -9,6 +10,7 @@
 #include "OrchestraException.h"
 #include "Var.h"
 #include "Parser.h"
+#include "VarGroupState.h"
 
 namespace orchestracpp { class Var; }
 namespace orchestracpp { class OrchestraReader; }
@@ -30,13 +32,19 @@ namespace orchestracpp
 
 	private:
         std::unordered_set <Var*>variables; // the variables, no duplicates, not ordered, so order not the same as Java  version!
-		std::map <std::string, Var*> variableIndx; // the variables by name 
+		std::map <std::string, Var*, std::less<>> variableIndx; // the variables by name, can be searched with a string_view 
 		std::vector<std::string> allVariableNames;
 		//std::vector<std::string> alphabeticVariableNames;
 
 
 	public:
 		std::vector<Var*> globalVariables;   // Variables that the calculator would like to see stored globally in nodes
+
+		std::vector<MemoryNode*> memoryNodes;     // all memory nodes in topological order (children first)
+
+		// The register file and dirty bitset of the calculator that owns this VarGroup.
+		// Created once the memory nodes are numbered and never resized.
+		VarGroupState state;
 		std::unordered_map <std::string, std::string> synonyms;
 
 		~VarGroup()
@@ -54,7 +62,7 @@ namespace orchestracpp
 		void createSynonym(OrchestraReader *in) /*throw(ReadException, IOException)*/;
 
 		// Get a variable by its name or synonym.
-		Var *get(const std::string &name);
+		Var *get(std::string_view name);
 
 		// This list includes synonyms
 		// we use a Vector because this collection is used in user interface swing objects
@@ -64,6 +72,22 @@ namespace orchestracpp
 
 		void setDependentMemoryNodes();
 
+		/**
+		 * Copy the current register file and dirty bitset of this thread into copy.
+		 */
+		void saveState(VarGroupState& copy);
+
+		/**
+		 * Restore a state saved with saveState, this does not invalidate any memory nodes.
+		 */
+		void restoreState(const VarGroupState& copy);
+
+		/**
+		 * Evaluate the expressions of the constant variables, so their memory nodes are
+		 * not written to anymore when the expression graph is shared by several calculators.
+		 */
+		void evaluateConstants();
+
 		//virtual void initializeParentsArrays();
 
 		int getNrVariables();
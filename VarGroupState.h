@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+namespace orchestracpp
+{
+
+	/**
+	 * The evaluation state of a VarGroup: the register file with the values of all
+	 * variables followed by the last values of the memory nodes, and the dirty bitset
+	 * of the memory nodes.
+	 * Once the register file is created the expression graph itself contains no state,
+	 * so calculators that share a graph each have their own VarGroupState. The state of
+	 * the calculator that is running on a thread is made current for that thread.
+	 */
+	struct VarGroupState
+	{
+		std::vector<double> registers;
+		std::vector<uint64_t> dirtyMemoryNodes;
+
+		static inline thread_local double* currentRegisters = nullptr;
+		static inline thread_local uint64_t* currentDirtyMemoryNodes = nullptr;
+
+		inline void makeCurrent()
+		{
+			currentRegisters = registers.data();
+			currentDirtyMemoryNodes = dirtyMemoryNodes.data();
+		}
+	};
+
+}
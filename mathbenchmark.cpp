@@ -0,0 +1,153 @@
+/* We comment this file out, so it does not mess up a standard compilation of all files in this folder with a single main program
+//--------------------------------------------------------------------------------------------------------------------------
+// This file is part of the C++ ORCHESTRA chemical solver code
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//--------------------------------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------------------------------
+// This benchmark compares the FastMath kernels (used with the @fastmath: keyword) with the standard library,
+// for the argument ranges that occur in chemical speciation calculations:
+//
+// exp10:  log10 activities and concentrations of species (-30 .. 5) and log10 equilibrium constants (-50 .. 50)
+// log10:  activities and concentrations (10^-30 .. 10^5)
+// exp:    temperature corrections and Boltzmann factors (-50 .. 50)
+// log:    activities and concentrations (10^-30 .. 10^5)
+//
+// For each function and range it reports the time per call of the standard library, of the scalar kernel
+// and of the array kernel (AVX-512 or AVX2 if compiled for it, e.g. with -O2 -march=native),
+// and the maximum error in ulp of the standard library and the kernels, against long double references.
+// It also checks that the array kernels give exactly the same results as the scalar kernels.
+//
+// Compile with, for example:
+//   c++ -std=c++17 -O2 -march=native mathbenchmark.cpp FastMath.cpp -o mathbenchmark
+// after removing the comment markers at the start and end of this file.
+//--------------------------------------------------------------------------------------------------------------------------
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include "FastMath.h"
+
+using namespace std;
+using namespace std::chrono;
+using namespace orchestracpp;
+
+// the error of y in units in the last place of the exact value
+double ulpError(double y, long double exact)
+{
+	double rounded = (double)exact;
+	if (rounded == 0.0 || !std::isfinite(rounded)) return 0.0;
+	int exponent;
+	std::frexp(rounded, &exponent);
+	return (double)(fabsl((long double)y - exact) / ldexpl(1.0L, exponent - 53));
+}
+
+template <class F>
+double nsPerCall(const vector<double>& x, vector<double>& y, int repeats, F f)
+{
+	auto t0 = high_resolution_clock::now();
+	for (int r = 0; r < repeats; r++)
+	{
+		f(x, y);
+	}
+	auto t1 = high_resolution_clock::now();
+	return (double)duration_cast<nanoseconds>(t1 - t0).count() / ((double)repeats * x.size());
+}
+
+template <class S, class K, class A, class R>
+void benchmark(string name, double low, double high, bool logarithmic, S standard, K kernel, A array, R exact)
+{
+	const int size = 4096;
+	const int repeats = 2000;
+	const int accuracySamples = 10000000;
+
+	mt19937_64 generator(1);
+	uniform_real_distribution<double> distribution(low, high);
+
+	vector<double> x(size), y(size), z(size);
+	for (auto& v : x)
+	{
+		v = distribution(generator);
+		if (logarithmic) v = std::pow(10.0, v);
+	}
+
+	double checksum = 0;
+	double tStandard = nsPerCall(x, y, repeats, [&](const vector<double>& a, vector<double>& b) { for (int i = 0; i < size; i++) b[i] = standard(a[i]); checksum += b[0]; });
+	double tScalar = nsPerCall(x, y, repeats, [&](const vector<double>& a, vector<double>& b) { for (int i = 0; i < size; i++) b[i] = kernel(a[i]); checksum += b[0]; });
+	double tArray = nsPerCall(x, z, repeats, [&](const vector<double>& a, vector<double>& b) { array(a.data(), b.data(), size); checksum += b[0]; });
+
+	int mismatches = 0;
+	for (int i = 0; i < size; i++)
+	{
+		if (std::memcmp(&y[i], &z[i], sizeof(double)) != 0) mismatches++;
+	}
+
+	double maxStandard = 0;
+	double maxKernel = 0;
+	for (int n = 0; n < accuracySamples; n++)
+	{
+		double v = distribution(generator);
+		if (logarithmic) v = std::pow(10.0, v);
+		long double e = exact((long double)v);
+		maxStandard = std::max(maxStandard, ulpError(standard(v), e));
+		maxKernel = std::max(maxKernel, ulpError(kernel(v), e));
+	}
+
+	cout << setw(6) << name << "  " << (logarithmic ? "10^" : "   ") << "[" << setw(4) << low << "," << setw(4) << high << "]"
+		<< fixed << setprecision(2)
+		<< "  std " << setw(6) << tStandard << " ns"
+		<< "  scalar " << setw(6) << tScalar << " ns"
+		<< "  array " << setw(6) << tArray << " ns"
+		<< "  speedup " << setw(5) << tStandard / tArray
+		<< "  max error std " << setprecision(3) << maxStandard << " ulp, kernel " << maxKernel << " ulp"
+		<< (mismatches > 0 ? "  ARRAY DIFFERS FROM SCALAR" : "")
+		<< defaultfloat << setprecision(6) << (checksum == 12345.0 ? " " : "") << "\n";
+}
+
+int main()
+{
+	cout << "FastMath kernels against the standard library, SIMD: " << FastMath::simdName() << "\n";
+
+	auto exp10Std = [](double x) { return std::pow(10.0, x); };
+	auto exp10Fast = [](double x) { return FastMath::exp10(x); };
+	auto exp10Array = [](const double* x, double* y, int n) { FastMath::exp10(x, y, n); };
+	auto exp10Exact = [](long double x) { return powl(10.0L, x); };
+	benchmark("exp10", -30, 5, false, exp10Std, exp10Fast, exp10Array, exp10Exact);
+	benchmark("exp10", -50, 50, false, exp10Std, exp10Fast, exp10Array, exp10Exact);
+
+	auto log10Std = [](double x) { return std::log10(x); };
+	auto log10Fast = [](double x) { return FastMath::log10(x); };
+	auto log10Array = [](const double* x, double* y, int n) { FastMath::log10(x, y, n); };
+	auto log10Exact = [](long double x) { return log10l(x); };
+	benchmark("log10", -30, 5, true, log10Std, log10Fast, log10Array, log10Exact);
+
+	auto expStd = [](double x) { return std::exp(x); };
+	auto expFast = [](double x) { return FastMath::exp(x); };
+	auto expArray = [](const double* x, double* y, int n) { FastMath::exp(x, y, n); };
+	auto expExact = [](long double x) { return expl(x); };
+	benchmark("exp", -50, 50, false, expStd, expFast, expArray, expExact);
+
+	auto logStd = [](double x) { return std::log(x); };
+	auto logFast = [](double x) { return FastMath::log(x); };
+	auto logArray = [](const double* x, double* y, int n) { FastMath::log(x, y, n); };
+	auto logExact = [](long double x) { return logl(x); };
+	benchmark("log", -30, 5, true, logStd, logFast, logArray, logExact);
+
+	return 0;
+}
+*/